@@ -0,0 +1,522 @@
+// Offline benchmark for the native build
+// Runs the real framework against loopback HTTP, WebSocket and telnet clients
+// and reports loop rate, request latency percentiles and heap churn.
+//
+//   pio run -e native -t exec
+//   .pio/build/native/program --seconds 20 --http-clients 4 --network-task
+//
+// The fake heap counts every malloc in the process, so the clients below
+// reuse buffers reserved up front and only the framework moves the numbers.
+#include "ESP32S3_EasyConnect.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <signal.h>
+
+namespace {
+
+struct BenchOptions {
+  int seconds = 10;
+  int httpClients = 2;
+  bool networkTask = false;
+  bool spin = false;   // Call loop() back to back instead of waitForEvents()
+  bool serial = false; // Keep the framework's serial log on stdout
+};
+
+enum BenchRoute {
+  ROUTE_HTTP_STATUS,
+  ROUTE_HTTP_CONFIG,
+  ROUTE_HTTP_METRICS,
+  ROUTE_HTTP_INDEX,
+  ROUTE_WS_GET_STATUS,
+  ROUTE_WS_COMMAND,
+  ROUTE_TELNET_COMMAND,
+  ROUTE_COUNT
+};
+
+const char* const ROUTE_NAMES[ROUTE_COUNT] = {
+  "GET /api/status", "GET /api/config", "GET /metrics", "GET /",
+  "WS getStatus", "WS cmd:status", "telnet status"
+};
+const char* const HTTP_PATHS[] = {"/api/status", "/api/config", "/metrics", "/"};
+// Reservations above glibc's mmap threshold (128 KB) stay out of the heap figures
+const size_t MAX_SAMPLES = 1 << 20;  // Per route
+const size_t CLIENT_BUFFER = 256 * 1024;
+
+// Latency samples per route, in microseconds
+class LatencyTable {
+public:
+  LatencyTable() {
+    for (auto& samples : routes) samples.reserve(MAX_SAMPLES);
+  }
+
+  void record(BenchRoute route, uint32_t micros) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (routes[route].size() < MAX_SAMPLES) routes[route].push_back(micros);
+  }
+
+  void fail(BenchRoute route) {
+    std::lock_guard<std::mutex> lock(mutex);
+    failures[route]++;
+  }
+
+  void print() {
+    std::lock_guard<std::mutex> lock(mutex);
+    printf("%-22s %8s %6s %9s %9s %9s %9s\n", "route", "count", "fail", "p50 us", "p90 us", "p99 us", "max us");
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+      std::vector<uint32_t>& samples = routes[i];
+      if (samples.empty() && failures[i] == 0) continue;
+      std::sort(samples.begin(), samples.end());
+      printf("%-22s %8zu %6u %9u %9u %9u %9u\n", ROUTE_NAMES[i], samples.size(), failures[i],
+             percentile(samples, 50), percentile(samples, 90), percentile(samples, 99),
+             samples.empty() ? 0 : samples.back());
+    }
+  }
+
+private:
+  static uint32_t percentile(const std::vector<uint32_t>& sorted, int p) {
+    if (sorted.empty()) return 0;
+    return sorted[(sorted.size() - 1) * p / 100];
+  }
+
+  std::mutex mutex;
+  std::vector<uint32_t> routes[ROUTE_COUNT];
+  unsigned failures[ROUTE_COUNT] = {};
+};
+
+LatencyTable* latencies = nullptr;
+std::atomic<bool> running(true);
+
+uint32_t elapsedMicros(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Blocking loopback socket with a receive timeout so a stalled server shows up as a failure
+int connectLoopback(uint16_t port, int timeoutSeconds = 2) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  timeval timeout = {timeoutSeconds, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(nativePort(port));
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool sendAll(int fd, const char* data, size_t length) {
+  size_t sent = 0;
+  while (sent < length) {
+    ssize_t n = send(fd, data + sent, length - sent, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+bool sendAll(int fd, const std::string& data) {
+  return sendAll(fd, data.data(), data.size());
+}
+
+// Read until the delimiter shows up, EOF (empty delimiter) or a timeout
+bool readUntil(int fd, std::string& buffer, const char* delimiter) {
+  char chunk[1024];
+  while (!*delimiter || buffer.find(delimiter) == std::string::npos) {
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n == 0) return !*delimiter;
+    if (n < 0) return false;
+    buffer.append(chunk, n);
+  }
+  return true;
+}
+
+bool readExact(int fd, std::string& buffer, size_t count) {
+  char chunk[1024];
+  while (buffer.size() < count) {
+    ssize_t n = recv(fd, chunk, std::min(sizeof(chunk), count - buffer.size()), 0);
+    if (n <= 0) return false;
+    buffer.append(chunk, n);
+  }
+  return true;
+}
+
+// Read one response framed by Content-Length or chunked encoding; the server
+// waits for the client to hang up (HC_WAIT_CLOSE), so EOF cannot end it
+bool readHttpResponse(int fd, std::string& response) {
+  if (!readUntil(fd, response, "\r\n\r\n")) return false;
+  size_t bodyStart = response.find("\r\n\r\n") + 4;
+
+  const char* headers = response.c_str();
+  const char* length = strcasestr(headers, "\r\nContent-Length:");
+  if (length && length < headers + bodyStart) {
+    return readExact(fd, response, bodyStart + strtoul(length + 17, nullptr, 10));
+  }
+  const char* chunked = strcasestr(headers, "\r\nTransfer-Encoding: chunked");
+  if (chunked && chunked < headers + bodyStart) {
+    return readUntil(fd, response, "\r\n0\r\n\r\n");
+  }
+  return readUntil(fd, response, "");
+}
+
+// One request per connection, like a browser polling the API
+void httpClient(int id) {
+  std::string requests[ROUTE_HTTP_INDEX + 1];
+  for (int i = 0; i <= ROUTE_HTTP_INDEX; i++) {
+    requests[i] = std::string("GET ") + HTTP_PATHS[i] + " HTTP/1.1\r\nHost: bench\r\nConnection: close\r\n\r\n";
+  }
+  std::string response;
+  response.reserve(CLIENT_BUFFER);
+  unsigned request = id;
+
+  while (running) {
+    int route = request++ % (ROUTE_HTTP_INDEX + 1);
+    auto started = std::chrono::steady_clock::now();
+
+    int fd = connectLoopback(80);
+    if (fd < 0) {
+      latencies->fail((BenchRoute)route);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
+
+    response.clear();
+    bool ok = sendAll(fd, requests[route]) && readHttpResponse(fd, response);
+    close(fd);
+
+    if (ok && response.compare(0, 12, "HTTP/1.1 200") == 0) {
+      latencies->record((BenchRoute)route, elapsedMicros(started));
+    } else {
+      latencies->fail((BenchRoute)route);
+    }
+  }
+}
+
+// Client-to-server frames must be masked; a zero mask keeps the payload readable
+bool sendWebSocketText(int fd, const char* text) {
+  uint8_t frame[6 + 125];
+  size_t length = strlen(text);
+  if (length > 125) return false;
+  frame[0] = 0x81;
+  frame[1] = 0x80 | length;
+  memset(frame + 2, 0, 4);
+  memcpy(frame + 6, text, length);
+  return sendAll(fd, (const char*)frame, 6 + length);
+}
+
+// Next unfragmented server frame; pending holds bytes read past the previous frame
+bool readWebSocketFrame(int fd, std::string& pending, std::string& payload) {
+  if (!readExact(fd, pending, 2)) return false;
+  size_t length = (uint8_t)pending[1] & 0x7F;
+  size_t header = 2;
+  if (length == 126) {
+    header = 4;
+    if (!readExact(fd, pending, header)) return false;
+    length = ((uint8_t)pending[2] << 8) | (uint8_t)pending[3];
+  } else if (length == 127) {
+    header = 10;
+    if (!readExact(fd, pending, header)) return false;
+    length = 0;
+    for (int i = 2; i < 10; i++) length = (length << 8) | (uint8_t)pending[i];
+  }
+  if (!readExact(fd, pending, header + length)) return false;
+  payload.assign(pending, header, length);
+  pending.erase(0, header + length);
+  return true;
+}
+
+// Send a request and wait for the reply frame, skipping broadcasts in between
+bool webSocketRoundTrip(int fd, std::string& pending, std::string& payload, const char* request, const char* reply) {
+  if (!sendWebSocketText(fd, request)) return false;
+  while (readWebSocketFrame(fd, pending, payload)) {
+    if (payload.find(reply) != std::string::npos) return true;
+  }
+  return false;
+}
+
+void webSocketClient() {
+  static const char* handshake =
+    "GET / HTTP/1.1\r\nHost: bench\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  std::string pending;
+  std::string payload;
+  pending.reserve(CLIENT_BUFFER);
+  payload.reserve(CLIENT_BUFFER);
+
+  while (running) {
+    int fd = connectLoopback(81);
+    pending.clear();
+    bool ok = fd >= 0 && sendAll(fd, handshake, strlen(handshake)) && readUntil(fd, pending, "\r\n\r\n");
+    if (ok) pending.erase(0, pending.find("\r\n\r\n") + 4);
+
+    while (ok && running) {
+      auto started = std::chrono::steady_clock::now();
+      ok = webSocketRoundTrip(fd, pending, payload, "getStatus", "\"full\":true");
+      if (!ok) break;
+      latencies->record(ROUTE_WS_GET_STATUS, elapsedMicros(started));
+
+      started = std::chrono::steady_clock::now();
+      ok = webSocketRoundTrip(fd, pending, payload, "cmd:status", "\"commandResult\"");
+      if (!ok) break;
+      latencies->record(ROUTE_WS_COMMAND, elapsedMicros(started));
+    }
+    if (!ok && running) {
+      latencies->fail(ROUTE_WS_GET_STATUS);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (fd >= 0) close(fd);
+  }
+}
+
+void telnetClient(uint16_t port) {
+  std::string buffer;
+  buffer.reserve(CLIENT_BUFFER);
+
+  while (running) {
+    int fd = connectLoopback(port);
+    buffer.clear();
+    bool ok = fd >= 0 && readUntil(fd, buffer, "> ");
+
+    while (ok && running) {
+      buffer.clear();
+      auto started = std::chrono::steady_clock::now();
+      ok = sendAll(fd, "status\r\n", 8) && readUntil(fd, buffer, "> ");
+      if (ok) latencies->record(ROUTE_TELNET_COMMAND, elapsedMicros(started));
+    }
+    if (!ok && running) {
+      latencies->fail(ROUTE_TELNET_COMMAND);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (fd >= 0) close(fd);
+  }
+}
+
+// 100 synthetic commands, looked up through a registry and through a
+// String comparison chain like the one the registry replaced
+void benchmarkCommands() {
+  static const int BENCH_COMMANDS = 100;
+  static const int BENCH_ROUNDS = 20;
+  static char names[BENCH_COMMANDS][8];
+
+  CommandRegistry* registry = new CommandRegistry();
+  for (int i = 0; i < BENCH_COMMANDS; i++) {
+    snprintf(names[i], sizeof(names[i]), "cmd%02d", i);
+    registry->add(names[i], "", "", PERMISSION_VIEWER, [](CommandContext&, void*) {}, nullptr);
+  }
+
+  String lines[BENCH_COMMANDS];
+  for (int i = 0; i < BENCH_COMMANDS; i++) {
+    lines[i] = names[i];
+  }
+
+  volatile int hits = 0;
+  unsigned long start = micros();
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+      if (registry->find(lines[i].c_str(), lines[i].length()) != nullptr) hits++;
+    }
+  }
+  unsigned long hashedMicros = micros() - start;
+
+  start = micros();
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+      for (int j = 0; j < BENCH_COMMANDS; j++) {
+        if (lines[i] == names[j]) {
+          hits++;
+          break;
+        }
+      }
+    }
+  }
+  unsigned long chainMicros = micros() - start;
+  delete registry;
+
+  int lookups = BENCH_COMMANDS * BENCH_ROUNDS;
+  printf("Command lookup, %d commands, %d lookups:\n", BENCH_COMMANDS, lookups);
+  printf("  Registry: %lu us (%.0f ns/lookup)\n", hashedMicros, hashedMicros * 1000.0 / lookups);
+  printf("  If/else chain: %lu us (%.0f ns/lookup)\n", chainMicros, chainMicros * 1000.0 / lookups);
+}
+
+// Same capturing subscribers behind DelegateList and std::function
+void benchmarkDelegates() {
+  static const int BENCH_SUBSCRIBERS = 4;
+  static const int BENCH_EVENTS = 2000;
+  volatile uint32_t sink = 0;
+  uint32_t scale = 3;
+
+  DelegateList<uint32_t>* delegates = new DelegateList<uint32_t>();
+  std::vector<std::function<void(uint32_t)>> functions;
+  functions.reserve(BENCH_SUBSCRIBERS);
+
+  // Three words of captured state, typical for "this plus a couple of values"
+  uint32_t heapBefore = ESP.getFreeHeap();
+  for (int i = 0; i < BENCH_SUBSCRIBERS; i++) {
+    uint32_t offset = i;
+    delegates->add([&sink, scale, offset](uint32_t value) { sink = sink + value * scale + offset; });
+  }
+  uint32_t delegateHeap = heapBefore - ESP.getFreeHeap();
+
+  heapBefore = ESP.getFreeHeap();
+  for (int i = 0; i < BENCH_SUBSCRIBERS; i++) {
+    uint32_t offset = i;
+    functions.push_back([&sink, scale, offset](uint32_t value) { sink = sink + value * scale + offset; });
+  }
+  uint32_t functionHeap = heapBefore - ESP.getFreeHeap();
+
+  unsigned long start = micros();
+  for (int i = 0; i < BENCH_EVENTS; i++) {
+    (*delegates)(i);
+  }
+  unsigned long delegateMicros = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < BENCH_EVENTS; i++) {
+    for (size_t k = 0; k < functions.size(); k++) {
+      functions[k](i);
+    }
+  }
+  unsigned long functionMicros = micros() - start;
+  delete delegates;
+
+  // String events: a by-value subscriber copies the message on every call,
+  // a const String& subscriber reads the caller's
+  DelegateList<String> byValue;
+  DelegateList<String> byReference;
+  String message = "{\"type\":\"custom\",\"payload\":\"longer than SSO\"}";
+  for (int i = 0; i < BENCH_SUBSCRIBERS; i++) {
+    byValue.add([&sink](String text) { sink = sink + text.length(); });
+    byReference.add([&sink](const String& text) { sink = sink + text.length(); });
+  }
+  start = micros();
+  for (int i = 0; i < BENCH_EVENTS; i++) {
+    byValue(message);
+  }
+  unsigned long byValueMicros = micros() - start;
+  start = micros();
+  for (int i = 0; i < BENCH_EVENTS; i++) {
+    byReference(message);
+  }
+  unsigned long byReferenceMicros = micros() - start;
+
+  int calls = BENCH_EVENTS * BENCH_SUBSCRIBERS;
+  printf("Event dispatch, %d capturing subscribers, %d events:\n", BENCH_SUBSCRIBERS, BENCH_EVENTS);
+  printf("  DelegateList: %lu us (%.0f ns/call), %u bytes heap\n", delegateMicros, delegateMicros * 1000.0 / calls, delegateHeap);
+  printf("  std::function: %lu us (%.0f ns/call), %u bytes heap\n", functionMicros, functionMicros * 1000.0 / calls, functionHeap);
+  printf("  String by value: %lu us (%.0f ns/call)\n", byValueMicros, byValueMicros * 1000.0 / calls);
+  printf("  const String&: %lu us (%.0f ns/call)\n", byReferenceMicros, byReferenceMicros * 1000.0 / calls);
+}
+
+void serviceFor(const BenchOptions& options, uint32_t milliseconds) {
+  unsigned long started = millis();
+  while (millis() - started < milliseconds) {
+    EasyConnect.loop();
+    if (!options.spin) EasyConnect.waitForEvents();
+  }
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options) {
+  for (int i = 1; i < argc; i++) {
+    String arg = argv[i];
+    if (arg == "--seconds" && i + 1 < argc) {
+      options.seconds = atoi(argv[++i]);
+    } else if (arg == "--http-clients" && i + 1 < argc) {
+      options.httpClients = atoi(argv[++i]);
+    } else if (arg == "--network-task") {
+      options.networkTask = true;
+    } else if (arg == "--spin") {
+      options.spin = true;
+    } else if (arg == "--serial") {
+      options.serial = true;
+    } else {
+      printf("usage: %s [--seconds N] [--http-clients N] [--network-task] [--spin] [--serial]\n", argv[0]);
+      return false;
+    }
+  }
+  return options.seconds > 0 && options.httpClients >= 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  BenchOptions options;
+  if (!parseOptions(argc, argv, options)) return 1;
+
+  // Clients that disconnect mid-write must not kill the process
+  signal(SIGPIPE, SIG_IGN);
+  if (!options.serial) Serial.setOutput(nullptr);
+  latencies = new LatencyTable();
+
+  if (options.networkTask) EasyConnect.enableNetworkTask();
+  if (!EasyConnect.begin("NativeBench")) {
+    printf("begin() failed\n");
+    return 1;
+  }
+  uint16_t telnetPort = EasyConnect.getConfig().telnetPort;
+
+  // Let WiFi events and the first status broadcast settle before starting clients
+  serviceFor(options, 500);
+  std::atomic<int> activeClients(options.httpClients + 2);
+  std::vector<std::thread> clients;
+  for (int i = 0; i < options.httpClients; i++) {
+    clients.emplace_back([i, &activeClients]() { httpClient(i); activeClients--; });
+  }
+  clients.emplace_back([&activeClients]() { webSocketClient(); activeClients--; });
+  clients.emplace_back([telnetPort, &activeClients]() { telnetClient(telnetPort); activeClients--; });
+
+  // Warm up so connection setup and first-use allocations stay out of the numbers
+  serviceFor(options, 500);
+  EasyConnect.resetLoopStats();
+  IdleStats idleBefore = EasyConnect.getIdleStats();
+  uint32_t heapBefore = ESP.getFreeHeap();
+
+  serviceFor(options, options.seconds * 1000UL);
+  LoopStats loopStats = EasyConnect.getLoopStats();
+  IdleStats idleStats = EasyConnect.getIdleStats();
+  uint32_t heapAfter = ESP.getFreeHeap();
+
+  // Clients finish their current request, so keep serving until they are gone
+  running = false;
+  while (activeClients > 0) serviceFor(options, 10);
+  for (auto& client : clients) client.join();
+
+  printf("\n== EasyConnect native benchmark: %d s, %d HTTP client(s), %s, %s ==\n\n",
+         options.seconds, options.httpClients,
+         options.networkTask ? "network task" : "single loop",
+         options.spin ? "spinning" : "waitForEvents()");
+  printf("loop iterations        %lu (%lu/s average, %lu/s last second)\n",
+         loopStats.iterations, loopStats.iterations / options.seconds, loopStats.iterationsPerSecond);
+  printf("loop duration          last %lu us, max %lu us\n", loopStats.lastLoopMicros, loopStats.maxLoopMicros);
+  printf("heap churn             %u bytes (%.1f bytes/iteration)\n", loopStats.heapChurn,
+         loopStats.iterations ? (double)loopStats.heapChurn / loopStats.iterations : 0.0);
+  printf("free heap              %u before, %u after, %u minimum\n", heapBefore, heapAfter, loopStats.minFreeHeap);
+  printf("idle                   %u waits (%u socket, %u signal, %u timeout), %.1f%% of wall time\n",
+         idleStats.waits - idleBefore.waits,
+         idleStats.socketWakeups - idleBefore.socketWakeups,
+         idleStats.signalWakeups - idleBefore.signalWakeups,
+         idleStats.timeoutWakeups - idleBefore.timeoutWakeups,
+         (idleStats.idleMicros - idleBefore.idleMicros) / (options.seconds * 10000.0));
+  printf("socket service         last %u us, max %u us\n\n", idleStats.lastServiceMicros, idleStats.maxServiceMicros);
+  latencies->print();
+
+  printf("\n");
+  benchmarkCommands();
+  benchmarkDelegates();
+
+  // A device never runs global destructors (WebServer deletes its handler
+  // chain, including the framework's member asset handler), so skip them
+  fflush(stdout);
+  _exit(0);
+}
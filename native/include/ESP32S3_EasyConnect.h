@@ -0,0 +1,4 @@
+// The library header is shipped as ESP32-S3_EasyConnect.h
+#pragma once
+
+#include "../../src/ESP32-S3_EasyConnect.h"
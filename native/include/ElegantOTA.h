@@ -0,0 +1,12 @@
+// Host stand-in for ElegantOTA: the /update page exists, flashing does not
+#pragma once
+
+#include <WebServer.h>
+
+class ElegantOTAClass {
+public:
+  void begin(WebServer* server, const char* username = "", const char* password = "");
+  void loop() {}
+};
+
+extern ElegantOTAClass ElegantOTA;
@@ -0,0 +1,18 @@
+// LittleFS on the host: a directory from EASYCONNECT_FS_ROOT, or a fresh temp dir
+#pragma once
+
+#include <FS.h>
+
+class LittleFSFS : public fs::FS {
+public:
+  ~LittleFSFS();
+
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs");
+  void end();
+  bool format();
+  size_t totalBytes();
+  size_t usedBytes();
+};
+
+extern LittleFSFS LittleFS;
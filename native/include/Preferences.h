@@ -0,0 +1,65 @@
+// Host stand-in for the NVS-backed Preferences library, kept in process memory
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+
+class Preferences {
+public:
+  ~Preferences() { end(); }
+
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = NULL);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putChar(const char* key, int8_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUChar(const char* key, uint8_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putShort(const char* key, int16_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUShort(const char* key, uint16_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putInt(const char* key, int32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putLong(const char* key, int32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putULong(const char* key, uint32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putFloat(const char* key, float value) { return putValue(key, &value, sizeof(value)); }
+  size_t putDouble(const char* key, double value) { return putValue(key, &value, sizeof(value)); }
+  size_t putBool(const char* key, bool value) { uint8_t v = value; return putValue(key, &v, sizeof(v)); }
+  size_t putString(const char* key, const char* value);
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t len) { return putValue(key, value, len); }
+
+  int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int32_t getLong(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  float getFloat(const char* key, float defaultValue = NAN) { return getValue(key, defaultValue); }
+  double getDouble(const char* key, double defaultValue = NAN) { return getValue(key, defaultValue); }
+  bool getBool(const char* key, bool defaultValue = false) { return getValue(key, (uint8_t)defaultValue) != 0; }
+  size_t getString(const char* key, char* value, size_t maxLen);
+  String getString(const char* key, String defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+  std::string space;
+  bool started = false;
+  bool readOnly = false;
+
+  size_t putValue(const char* key, const void* value, size_t len);
+  bool findValue(const char* key, std::string& value);
+
+  template <typename T>
+  T getValue(const char* key, T defaultValue) {
+    std::string value;
+    if (!findValue(key, value) || value.size() != sizeof(T)) return defaultValue;
+    T result;
+    memcpy(&result, value.data(), sizeof(T));
+    return result;
+  }
+};
@@ -0,0 +1,163 @@
+// Host stand-in for the arduino-esp32 WebServer: same request state machine,
+// handler chain and response framing, over a WiFiServer socket
+#pragma once
+
+#include <WiFi.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPClientStatus { HC_NONE, HC_WAIT_READ, HC_WAIT_CLOSE };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+
+#define HTTP_MAX_DATA_WAIT 5000
+#define HTTP_MAX_POST_WAIT 5000
+#define HTTP_MAX_CLOSE_WAIT 2000
+#define HTTP_MAX_BODY 16384
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+typedef struct {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[1436];
+} HTTPUpload;
+
+class WebServer;
+
+class RequestHandler {
+public:
+  virtual ~RequestHandler() {}
+  virtual bool canHandle(HTTPMethod method, String uri) { return false; }
+  virtual bool canUpload(String uri) { return false; }
+  virtual bool handle(WebServer& server, HTTPMethod requestMethod, String requestUri) { return false; }
+  virtual void upload(WebServer& server, String requestUri, HTTPUpload& upload) {}
+
+  RequestHandler* next() { return _next; }
+  void next(RequestHandler* r) { _next = r; }
+
+private:
+  RequestHandler* _next = nullptr;
+};
+
+class StaticRequestHandler : public RequestHandler {
+public:
+  StaticRequestHandler(fs::FS& fs, const char* path, const char* uri, const char* cacheHeader);
+
+  bool canHandle(HTTPMethod requestMethod, String requestUri) override;
+  bool handle(WebServer& server, HTTPMethod requestMethod, String requestUri) override;
+  StaticRequestHandler& setDefaultFile(const char* file) { _defaultFile = file; return *this; }
+
+  static String getContentType(const String& path);
+
+protected:
+  fs::FS _fs;
+  String _uri;
+  String _path;
+  String _cacheHeader;
+  String _defaultFile = "index.htm";
+  bool _isFile;
+  size_t _baseUriLength;
+};
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  WebServer(int port = 80);
+  virtual ~WebServer();
+
+  virtual void begin();
+  virtual void begin(uint16_t port);
+  virtual void handleClient();
+  virtual void close();
+  void stop() { close(); }
+
+  WebServer& on(const String& uri, THandlerFunction fn);
+  WebServer& on(const String& uri, HTTPMethod method, THandlerFunction fn);
+  WebServer& on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn);
+  void addHandler(RequestHandler* handler);
+  StaticRequestHandler& serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheHeader = NULL);
+  void onNotFound(THandlerFunction fn) { _notFoundHandler = fn; }
+
+  String uri() { return _currentUri; }
+  HTTPMethod method() { return _currentMethod; }
+  WiFiClient client() { return _currentClient; }
+
+  String arg(const String& name);
+  String arg(int i);
+  String argName(int i);
+  int args() { return (int)_currentArgs.size(); }
+  bool hasArg(const String& name);
+  void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+  String header(const String& name);
+  String header(int i);
+  String headerName(int i);
+  int headers() { return (int)_currentHeaders.size(); }
+  bool hasHeader(const String& name);
+  String hostHeader() { return _hostHeader; }
+
+  void send(int code, const char* contentType = NULL, const String& content = String(""));
+  void send(int code, char* contentType, const String& content) { send(code, (const char*)contentType, content); }
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+  void send(int code, const char* contentType, const char* content);
+  void send_P(int code, PGM_P contentType, PGM_P content);
+  void send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength);
+
+  void setContentLength(const size_t contentLength) { _contentLength = contentLength; }
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t contentLength);
+  void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+  void sendContent_P(PGM_P content, size_t size) { sendContent(content, size); }
+
+  static String urlDecode(const String& text);
+
+  template <typename T>
+  size_t streamFile(T& file, const String& contentType, const int code = 200) {
+    _streamFileCore(file.size(), file.name(), contentType, code);
+    return _currentClient.write(file);
+  }
+
+protected:
+  struct RequestArgument {
+    String key;
+    String value;
+  };
+
+  bool _parseRequest(WiFiClient& client);
+  void _parseArguments(const String& data);
+  void _handleRequest();
+  void _finalizeResponse();
+  void _prepareHeader(String& response, int code, const char* contentType, size_t contentLength);
+  void _addRequestHandler(RequestHandler* handler);
+  void _streamFileCore(const size_t fileSize, const String& fileName, const String& contentType, const int code);
+  static const char* _responseCodeToString(int code);
+
+  WiFiServer _server;
+  WiFiClient _currentClient;
+  HTTPMethod _currentMethod = HTTP_ANY;
+  String _currentUri;
+  uint8_t _currentVersion = 1;
+  HTTPClientStatus _currentStatus = HC_NONE;
+  unsigned long _statusChange = 0;
+
+  RequestHandler* _currentHandler = nullptr;
+  RequestHandler* _firstHandler = nullptr;
+  RequestHandler* _lastHandler = nullptr;
+  THandlerFunction _notFoundHandler;
+
+  std::vector<RequestArgument> _currentArgs;
+  std::vector<RequestArgument> _currentHeaders;
+  std::vector<String> _collectedHeaderKeys;
+  size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+  String _responseHeaders;
+  String _hostHeader;
+  bool _chunked = false;
+};
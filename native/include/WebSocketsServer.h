@@ -0,0 +1,108 @@
+// Host stand-in for links2004 WebSocketsServer: RFC 6455 handshake and framing
+// over WiFiServer sockets, events delivered from loop()
+#pragma once
+
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+#define WEBSOCKETS_MAX_HEADER_SIZE 14
+#define WEBSOCKETS_MAX_DATA_SIZE (15 * 1024)
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG
+} WStype_t;
+
+typedef enum {
+  WSC_NOT_CONNECTED,
+  WSC_HEADER,
+  WSC_BODY,
+  WSC_CONNECTED
+} WSclientsStatus_t;
+
+typedef enum {
+  WSop_continuation = 0x00,
+  WSop_text = 0x01,
+  WSop_binary = 0x02,
+  WSop_close = 0x08,
+  WSop_ping = 0x09,
+  WSop_pong = 0x0A
+} WSopcode_t;
+
+typedef struct {
+  uint8_t num;
+  WSclientsStatus_t status;
+  WiFiClient* tcp;
+  String cUrl;
+  String cKey;
+  String cHeader;
+  std::vector<uint8_t> rx;
+  std::vector<uint8_t> fragment;
+  WSopcode_t fragmentOpcode;
+} WSclient_t;
+
+class WebSocketsServer {
+public:
+  typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)> WebSocketServerEvent;
+
+  WebSocketsServer(uint16_t port, const String& origin = "", const String& protocol = "arduino");
+  virtual ~WebSocketsServer();
+
+  void begin();
+  void close();
+  void loop();
+  void onEvent(WebSocketServerEvent cbEvent) { _cbEvent = cbEvent; }
+
+  bool sendTXT(uint8_t num, uint8_t* payload, size_t length = 0, bool headerToPayload = false);
+  bool sendTXT(uint8_t num, const uint8_t* payload, size_t length = 0);
+  bool sendTXT(uint8_t num, char* payload, size_t length = 0, bool headerToPayload = false);
+  bool sendTXT(uint8_t num, const char* payload, size_t length = 0);
+  bool sendTXT(uint8_t num, String& payload);
+  bool broadcastTXT(uint8_t* payload, size_t length = 0, bool headerToPayload = false);
+  bool broadcastTXT(const uint8_t* payload, size_t length = 0);
+  bool broadcastTXT(char* payload, size_t length = 0, bool headerToPayload = false);
+  bool broadcastTXT(const char* payload, size_t length = 0);
+  bool broadcastTXT(String& payload);
+  bool sendBIN(uint8_t num, uint8_t* payload, size_t length, bool headerToPayload = false);
+  bool sendBIN(uint8_t num, const uint8_t* payload, size_t length);
+  bool broadcastBIN(uint8_t* payload, size_t length, bool headerToPayload = false);
+  bool broadcastBIN(const uint8_t* payload, size_t length);
+  bool sendPing(uint8_t num, uint8_t* payload = NULL, size_t length = 0);
+
+  void disconnect();
+  void disconnect(uint8_t num);
+  uint8_t connectedClients(bool ping = false);
+  bool clientIsConnected(uint8_t num);
+  IPAddress remoteIP(uint8_t num);
+  void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount) {}
+  void disableHeartbeat() {}
+
+protected:
+  uint16_t _port;
+  String _origin;
+  String _protocol;
+  WiFiServer* _server;
+  WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+  WebSocketServerEvent _cbEvent;
+
+  bool clientIsConnected(WSclient_t* client);
+  void handleNewClients();
+  void handleHeader(WSclient_t* client);
+  void handleFrames(WSclient_t* client);
+  void clientDisconnect(WSclient_t* client);
+  bool sendFrame(WSclient_t* client, WSopcode_t opcode, const uint8_t* payload, size_t length);
+  void runCbEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+    if (_cbEvent) _cbEvent(num, type, payload, length);
+  }
+};
@@ -0,0 +1,231 @@
+// Host stand-in for the ESP32 WiFi library: the station is always on loopback
+// and WiFiClient/WiFiServer wrap real POSIX sockets
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+#include <lwip/sockets.h>
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_MODE_NULL = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+typedef enum {
+  WIFI_AUTH_OPEN = 0,
+  WIFI_AUTH_WEP,
+  WIFI_AUTH_WPA_PSK,
+  WIFI_AUTH_WPA2_PSK,
+  WIFI_AUTH_WPA_WPA2_PSK,
+  WIFI_AUTH_WPA2_ENTERPRISE,
+  WIFI_AUTH_WPA3_PSK
+} wifi_auth_mode_t;
+
+typedef enum {
+  WIFI_REASON_UNSPECIFIED = 1,
+  WIFI_REASON_AUTH_EXPIRE = 2,
+  WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+  WIFI_REASON_BEACON_TIMEOUT = 200,
+  WIFI_REASON_NO_AP_FOUND = 201,
+  WIFI_REASON_AUTH_FAIL = 202,
+  WIFI_REASON_ASSOC_FAIL = 203,
+  WIFI_REASON_HANDSHAKE_TIMEOUT = 204,
+  WIFI_REASON_CONNECTION_FAIL = 205
+} wifi_err_reason_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0,
+  ARDUINO_EVENT_WIFI_SCAN_DONE,
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+  ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+
+typedef struct {
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+  uint8_t bssid[6];
+  uint8_t reason;
+  int8_t rssi;
+} wifi_event_sta_disconnected_t;
+
+typedef struct {
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+  uint8_t bssid[6];
+  uint8_t channel;
+  wifi_auth_mode_t authmode;
+} wifi_event_sta_connected_t;
+
+typedef union {
+  wifi_event_sta_connected_t wifi_sta_connected;
+  wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef arduino_event_info_t WiFiEventInfo_t;
+typedef size_t wifi_event_id_t;
+typedef void (*WiFiEventCb)(WiFiEvent_t event);
+typedef std::function<void(WiFiEvent_t event, WiFiEventInfo_t info)> WiFiEventFuncCb;
+typedef void (*WiFiEventSysCb)(WiFiEvent_t event, WiFiEventInfo_t info);
+
+// Native only: device ports are shifted by EASYCONNECT_PORT_OFFSET (default 8000)
+// so the framework can listen on 80/81/23 without root
+uint16_t nativePort(uint16_t devicePort);
+
+class WiFiClientSocket;
+
+class WiFiClient : public Stream {
+public:
+  WiFiClient();
+  explicit WiFiClient(int fd);
+
+  int connect(IPAddress ip, uint16_t port);
+  int connect(const char* host, uint16_t port);
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  size_t write(Stream& stream);
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size);
+  int peek() override;
+  void flush() override {}
+  void stop();
+  uint8_t connected();
+  operator bool() { return connected(); }
+  bool operator==(const WiFiClient& rhs) const { return socket == rhs.socket; }
+  bool operator!=(const WiFiClient& rhs) const { return socket != rhs.socket; }
+
+  IPAddress remoteIP() const;
+  uint16_t remotePort() const;
+  IPAddress localIP() const;
+  uint16_t localPort() const;
+  int fd() const;
+  int setNoDelay(bool nodelay);
+  void setTimeout(uint32_t seconds) { Stream::setTimeout(seconds * 1000); }
+  using Print::write;
+
+private:
+  std::shared_ptr<WiFiClientSocket> socket;
+};
+
+class WiFiServer {
+public:
+  WiFiServer(uint16_t port = 80, uint8_t maxClients = 4);
+  ~WiFiServer() { end(); }
+
+  void begin(uint16_t port = 0);
+  void setNoDelay(bool nodelay) { noDelay = nodelay; }
+  bool getNoDelay() const { return noDelay; }
+  bool hasClient();
+  WiFiClient available() { return accept(); }
+  WiFiClient accept();
+  void end();
+  void stop() { end(); }
+  void close() { end(); }
+  operator bool() { return listening; }
+
+private:
+  int sockfd;
+  int acceptedSockfd;
+  uint16_t port;
+  uint8_t maxClients;
+  bool listening;
+  bool noDelay;
+};
+
+class WiFiClass {
+public:
+  wl_status_t begin(const char* ssid, const char* passphrase = NULL, int32_t channel = 0,
+                    const uint8_t* bssid = NULL, bool connect = true);
+  wl_status_t begin();
+  bool reconnect();
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  wl_status_t status() { return linkStatus.load(); }
+  bool isConnected() { return linkStatus == WL_CONNECTED; }
+
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet,
+              IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress()) { return true; }
+  bool mode(wifi_mode_t m) { wifiMode = m; return true; }
+  wifi_mode_t getMode() { return wifiMode; }
+  bool setAutoReconnect(bool autoReconnect) { return true; }
+  bool setSleep(bool enabled) { return true; }
+  bool persistent(bool persistent) { return true; }
+  bool setHostname(const char* name) { return true; }
+
+  IPAddress localIP() { return linkStatus == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress(); }
+  IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+  IPAddress dnsIP(uint8_t index = 0) { return IPAddress(127, 0, 0, 1); }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  String macAddress() { return "02:00:00:EC:00:01"; }
+  String SSID() { return linkStatus == WL_CONNECTED ? ssid : String(); }
+  String psk() { return passphrase; }
+  int32_t RSSI() { return linkStatus == WL_CONNECTED ? -52 : 0; }
+  int32_t channel() { return 6; }
+  uint8_t* BSSID();
+  String BSSIDstr();
+
+  int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                       uint32_t maxMsPerChan = 300, uint8_t channel = 0);
+  int16_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t index);
+  int32_t RSSI(uint8_t index);
+  int32_t channel(uint8_t index);
+  uint8_t* BSSID(uint8_t index);
+  wifi_auth_mode_t encryptionType(uint8_t index);
+
+  wifi_event_id_t onEvent(WiFiEventCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  wifi_event_id_t onEvent(WiFiEventFuncCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  wifi_event_id_t onEvent(WiFiEventSysCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  void removeEvent(wifi_event_id_t id);
+
+  // Native only: drop the link as an access point would, events included
+  void simulateDisconnect(uint8_t reason = WIFI_REASON_BEACON_TIMEOUT);
+
+private:
+  struct EventHandler {
+    wifi_event_id_t id;
+    arduino_event_id_t event;
+    WiFiEventFuncCb callback;
+  };
+
+  std::atomic<wl_status_t> linkStatus{WL_DISCONNECTED};
+  wifi_mode_t wifiMode = WIFI_MODE_NULL;
+  String ssid = "EasyConnect-Native";
+  String passphrase;
+  std::vector<EventHandler> handlers;
+  wifi_event_id_t nextHandlerId = 1;
+  unsigned long scanStarted = 0;
+  int16_t scanState = WIFI_SCAN_FAILED;
+
+  void connectLater();
+  void dispatch(arduino_event_id_t event, const WiFiEventInfo_t& info);
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,61 @@
+// Host stand-in for tzapu/WiFiManager: saved credentials always connect,
+// the portal never opens
+#pragma once
+
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+
+class WiFiManagerParameter {
+public:
+  WiFiManagerParameter(const char* id, const char* label, const char* defaultValue, int length);
+  ~WiFiManagerParameter();
+
+  const char* getID() const { return id; }
+  const char* getLabel() const { return label; }
+  const char* getValue() const { return value; }
+  int getValueLength() const { return length; }
+  void setValue(const char* defaultValue, int length);
+
+private:
+  WiFiManagerParameter(const WiFiManagerParameter&);
+  WiFiManagerParameter& operator=(const WiFiManagerParameter&);
+
+  const char* id;
+  const char* label;
+  char* value;
+  int length;
+};
+
+class WiFiManager {
+public:
+  bool autoConnect(const char* apName = NULL, const char* apPassword = NULL);
+  bool startConfigPortal(const char* apName = NULL, const char* apPassword = NULL);
+  bool process() { return false; }
+  bool getConfigPortalActive() { return portalActive; }
+  void stopConfigPortal() { portalActive = false; }
+  void resetSettings() { saved = false; }
+
+  void setTimeout(unsigned long seconds) {}
+  void setConfigPortalTimeout(unsigned long seconds) {}
+  void setConnectTimeout(unsigned long seconds) {}
+  void setConfigPortalBlocking(bool shouldBlock) {}
+  void setEnableConfigPortal(bool enable) {}
+  void setWiFiAutoReconnect(bool enable) {}
+  void setAPCallback(std::function<void(WiFiManager*)> func) { apCallback = func; }
+  void setSaveConfigCallback(std::function<void()> func) { saveCallback = func; }
+  void setSaveParamsCallback(std::function<void()> func) { saveParamsCallback = func; }
+  bool addParameter(WiFiManagerParameter* p) { params.push_back(p); return true; }
+
+  String getWiFiSSID(bool persistent = true) { return saved ? WiFi.SSID() : String(); }
+  String getWiFiPass(bool persistent = true) { return saved ? WiFi.psk() : String(); }
+  bool getWiFiIsSaved() { return saved; }
+
+private:
+  std::vector<WiFiManagerParameter*> params;
+  std::function<void(WiFiManager*)> apCallback;
+  std::function<void()> saveCallback;
+  std::function<void()> saveParamsCallback;
+  bool portalActive = false;
+  bool saved = true;
+};
@@ -0,0 +1,18 @@
+// lwIP socket API maps straight onto POSIX sockets on the host
+#pragma once
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+
+// Host descriptors start at 0; the range only bounds one-off socket lookups
+#define LWIP_SOCKET_OFFSET 0
+#define CONFIG_LWIP_MAX_SOCKETS 64
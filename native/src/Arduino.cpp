@@ -0,0 +1,614 @@
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <chrono>
+#include <thread>
+#include <ctype.h>
+#include <malloc.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ---------------------------------------------------------------- time
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+static uint64_t uptimeMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long millis() {
+  return (uint32_t)(uptimeMicros() / 1000);
+}
+
+unsigned long micros() {
+  return (uint32_t)uptimeMicros();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+long random(long howbig) {
+  return howbig > 0 ? ::random() % howbig : 0;
+}
+
+long random(long howsmall, long howbig) {
+  return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t val) {}
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t n = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return length;
+}
+#endif
+
+// ---------------------------------------------------------------- String
+
+String::String(const char* cstr) : buffer(nullptr), capacity(0), len(0) {
+  if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, unsigned int length) : buffer(nullptr), capacity(0), len(0) {
+  if (cstr) copy(cstr, length);
+}
+
+String::String(const String& str) : buffer(nullptr), capacity(0), len(0) {
+  copy(str.c_str(), str.len);
+}
+
+String::String(String&& rval) : buffer(nullptr), capacity(0), len(0) {
+  move(rval);
+}
+
+String::String(char c) : buffer(nullptr), capacity(0), len(0) {
+  copy(&c, 1);
+}
+
+static const char* formatInteger(char* buf, size_t size, unsigned long long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36) base = 10;
+  char* p = buf + size - 1;
+  *p = '\0';
+  do {
+    unsigned digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  if (negative) *--p = '-';
+  return p;
+}
+
+#define STRING_FROM_SIGNED(type) \
+  String::String(type value, unsigned char base) : buffer(nullptr), capacity(0), len(0) { \
+    char buf[72]; \
+    bool negative = value < 0 && base == 10; \
+    unsigned long long magnitude = negative ? 0ULL - (unsigned long long)value \
+                                            : (unsigned long long)(unsigned type)value; \
+    const char* text = formatInteger(buf, sizeof(buf), magnitude, negative, base); \
+    copy(text, strlen(text)); \
+  }
+
+#define STRING_FROM_UNSIGNED(type) \
+  String::String(type value, unsigned char base) : buffer(nullptr), capacity(0), len(0) { \
+    char buf[72]; \
+    const char* text = formatInteger(buf, sizeof(buf), value, false, base); \
+    copy(text, strlen(text)); \
+  }
+
+STRING_FROM_SIGNED(int)
+STRING_FROM_SIGNED(long)
+STRING_FROM_SIGNED(long long)
+STRING_FROM_UNSIGNED(unsigned int)
+STRING_FROM_UNSIGNED(unsigned long)
+STRING_FROM_UNSIGNED(unsigned long long)
+
+String::String(float value, unsigned char decimalPlaces) : buffer(nullptr), capacity(0), len(0) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, (double)value);
+  copy(buf, strlen(buf));
+}
+
+String::String(double value, unsigned char decimalPlaces) : buffer(nullptr), capacity(0), len(0) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  copy(buf, strlen(buf));
+}
+
+String::~String() {
+  free(buffer);
+}
+
+bool String::grow(unsigned int size) {
+  if (buffer && capacity >= size) return true;
+  char* newBuffer = (char*)realloc(buffer, size + 1);
+  if (!newBuffer) return false;
+  if (!buffer) newBuffer[0] = '\0';
+  buffer = newBuffer;
+  capacity = size;
+  return true;
+}
+
+bool String::reserve(unsigned int size) {
+  if (!grow(size)) return false;
+  buffer[len] = '\0';
+  return true;
+}
+
+String& String::copy(const char* cstr, unsigned int length) {
+  if (!grow(length)) {
+    free(buffer);
+    buffer = nullptr;
+    capacity = len = 0;
+    return *this;
+  }
+  len = length;
+  memmove(buffer, cstr, length);
+  buffer[len] = '\0';
+  return *this;
+}
+
+void String::move(String& rhs) {
+  if (this == &rhs) return;
+  free(buffer);
+  buffer = rhs.buffer;
+  capacity = rhs.capacity;
+  len = rhs.len;
+  rhs.buffer = nullptr;
+  rhs.capacity = rhs.len = 0;
+}
+
+String& String::operator=(const String& rhs) {
+  if (this != &rhs) copy(rhs.c_str(), rhs.len);
+  return *this;
+}
+
+String& String::operator=(String&& rval) {
+  move(rval);
+  return *this;
+}
+
+String& String::operator=(const char* cstr) {
+  return cstr ? copy(cstr, strlen(cstr)) : copy("", 0);
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+  if (!cstr) return false;
+  if (length == 0) return true;
+  unsigned int newLength = len + length;
+  // Appending a slice of ourselves survives the realloc
+  if (buffer && cstr >= buffer && cstr < buffer + len) {
+    size_t offset = cstr - buffer;
+    if (!grow(newLength)) return false;
+    cstr = buffer + offset;
+  } else if (!grow(newLength)) {
+    return false;
+  }
+  memmove(buffer + len, cstr, length);
+  len = newLength;
+  buffer[len] = '\0';
+  return true;
+}
+
+bool String::concat(const String& str) { return concat(str.c_str(), str.len); }
+bool String::concat(const char* cstr) { return cstr ? concat(cstr, strlen(cstr)) : false; }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+String operator+(const String& lhs, const String& rhs) {
+  String result;
+  result.reserve(lhs.length() + rhs.length());
+  result.concat(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+  String result;
+  size_t rhsLength = rhs ? strlen(rhs) : 0;
+  result.reserve(lhs.length() + rhsLength);
+  result.concat(lhs);
+  if (rhs) result.concat(rhs, rhsLength);
+  return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, char rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(String&& lhs, const String& rhs) {
+  lhs.concat(rhs);
+  return std::move(lhs);
+}
+
+String operator+(String&& lhs, const char* rhs) {
+  lhs.concat(rhs);
+  return std::move(lhs);
+}
+
+String operator+(String&& lhs, char rhs) {
+  lhs.concat(rhs);
+  return std::move(lhs);
+}
+
+int String::compareTo(const String& s) const {
+  return strcmp(c_str(), s.c_str());
+}
+
+bool String::equals(const String& s) const {
+  return len == s.len && memcmp(c_str(), s.c_str(), len) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+  if (!cstr) return len == 0;
+  return strcmp(c_str(), cstr) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  return len == s.len && strcasecmp(c_str(), s.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset > len || prefix.len > len - offset) return false;
+  return strncmp(c_str() + offset, prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+  return startsWith(prefix, 0);
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix.len > len) return false;
+  return strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return index < len ? buffer[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < len) buffer[index] = c;
+}
+
+char String::operator[](unsigned int index) const {
+  return charAt(index);
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= len) {
+    dummy = '\0';
+    return dummy;
+  }
+  return buffer[index];
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= len) return -1;
+  const char* found = (const char*)memchr(buffer + fromIndex, ch, len - fromIndex);
+  return found ? (int)(found - buffer) : -1;
+}
+
+int String::indexOf(const char* str, unsigned int fromIndex) const {
+  if (fromIndex > len || !str) return -1;
+  const char* found = strstr(c_str() + fromIndex, str);
+  return found ? (int)(found - c_str()) : -1;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  return indexOf(str.c_str(), fromIndex);
+}
+
+int String::lastIndexOf(char ch) const {
+  return len == 0 ? -1 : lastIndexOf(ch, len - 1);
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const {
+  if (len == 0) return -1;
+  if (fromIndex >= len) fromIndex = len - 1;
+  for (int i = (int)fromIndex; i >= 0; i--) {
+    if (buffer[i] == ch) return i;
+  }
+  return -1;
+}
+
+String String::substring(unsigned int beginIndex) const {
+  return substring(beginIndex, len);
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+  if (beginIndex >= len) return String();
+  if (endIndex > len) endIndex = len;
+  return String(buffer + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replace) {
+  for (unsigned int i = 0; i < len; i++) {
+    if (buffer[i] == find) buffer[i] = replace;
+  }
+}
+
+void String::replace(const String& find, const String& replace) {
+  if (find.len == 0 || len == 0) return;
+  String result;
+  unsigned int from = 0;
+  int at;
+  while ((at = indexOf(find, from)) >= 0) {
+    result.concat(buffer + from, at - from);
+    result.concat(replace);
+    from = at + find.len;
+  }
+  result.concat(buffer + from, len - from);
+  move(result);
+}
+
+void String::remove(unsigned int index) {
+  remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= len) return;
+  if (count > len - index) count = len - index;
+  memmove(buffer + index, buffer + index + count, len - index - count);
+  len -= count;
+  buffer[len] = '\0';
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < len; i++) buffer[i] = tolower((unsigned char)buffer[i]);
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < len; i++) buffer[i] = toupper((unsigned char)buffer[i]);
+}
+
+void String::trim() {
+  if (len == 0) return;
+  unsigned int begin = 0;
+  while (begin < len && isspace((unsigned char)buffer[begin])) begin++;
+  unsigned int end = len;
+  while (end > begin && isspace((unsigned char)buffer[end - 1])) end--;
+  len = end - begin;
+  if (begin > 0) memmove(buffer, buffer + begin, len);
+  buffer[len] = '\0';
+}
+
+long String::toInt() const {
+  return atol(c_str());
+}
+
+float String::toFloat() const {
+  return (float)atof(c_str());
+}
+
+double String::toDouble() const {
+  return atof(c_str());
+}
+
+// ---------------------------------------------------------------- Print
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (!write(*buffer++)) break;
+    n++;
+  }
+  return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char local[128];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(local, sizeof(local), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(local)) return write((const uint8_t*)local, length);
+
+  std::unique_ptr<char[]> heap(new char[length + 1]);
+  va_start(args, format);
+  vsnprintf(heap.get(), length + 1, format, args);
+  va_end(args);
+  return write((const uint8_t*)heap.get(), length);
+}
+
+size_t Print::printNumber(unsigned long long n, uint8_t base) {
+  char buf[72];
+  const char* text = formatInteger(buf, sizeof(buf), n, false, base);
+  return write(text);
+}
+
+size_t Print::print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+size_t Print::print(const char* s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char b, int base) { return print((unsigned long long)b, base); }
+size_t Print::print(int n, int base) { return print((long long)n, base); }
+size_t Print::print(unsigned int n, int base) { return print((unsigned long long)n, base); }
+size_t Print::print(long n, int base) { return print((long long)n, base); }
+size_t Print::print(unsigned long n, int base) { return print((unsigned long long)n, base); }
+
+size_t Print::print(long long n, int base) {
+  if (base == 10 && n < 0) return print('-') + printNumber(0ULL - (unsigned long long)n, 10);
+  return printNumber((unsigned long long)n, base);
+}
+
+size_t Print::print(unsigned long long n, int base) {
+  if (base == 0) return write((uint8_t)n);
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::print(const IPAddress& ip) { return print(ip.toString()); }
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const String& s) { return print(s) + println(); }
+size_t Print::println(const char* s) { return print(s) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char b, int base) { return print(b, base) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(long long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
+size_t Print::println(const IPAddress& ip) { return print(ip) + println(); }
+
+// ---------------------------------------------------------------- Stream
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String result;
+  int c;
+  while ((c = timedRead()) >= 0) result += (char)c;
+  return result;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String result;
+  int c;
+  while ((c = timedRead()) >= 0 && c != terminator) result += (char)c;
+  return result;
+}
+
+// ---------------------------------------------------------------- Serial
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (output) fwrite(buffer, 1, size, output);
+  return size;
+}
+
+void HardwareSerial::flush() {
+  if (output) fflush(output);
+}
+
+// ---------------------------------------------------------------- IPAddress
+
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  uint8_t* bytes = (uint8_t*)&address;
+  bytes[0] = a;
+  bytes[1] = b;
+  bytes[2] = c;
+  bytes[3] = d;
+}
+
+bool IPAddress::fromString(const char* text) {
+  unsigned a, b, c, d;
+  char tail;
+  if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4) return false;
+  if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+  *this = IPAddress(a, b, c, d);
+  return true;
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(buf);
+}
+
+// ---------------------------------------------------------------- ESP
+
+// Same heap budget as an ESP32-S3 without PSRAM; usage is what the process
+// allocated since the first query, so the numbers move like they do on the chip
+static const uint32_t NATIVE_HEAP_SIZE = 320 * 1024;
+
+static size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+static std::atomic<uint32_t> minFreeHeap(NATIVE_HEAP_SIZE);
+
+uint32_t EspClass::getHeapSize() {
+  return NATIVE_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  static const size_t baseline = heapInUse();
+  size_t used = heapInUse();
+  used = used > baseline ? used - baseline : 0;
+  uint32_t freeHeap = used < NATIVE_HEAP_SIZE ? NATIVE_HEAP_SIZE - (uint32_t)used : 0;
+
+  uint32_t low = minFreeHeap.load(std::memory_order_relaxed);
+  while (freeHeap < low && !minFreeHeap.compare_exchange_weak(low, freeHeap, std::memory_order_relaxed)) {
+  }
+  return freeHeap;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  getFreeHeap();
+  return minFreeHeap.load(std::memory_order_relaxed);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return getFreeHeap() / 2;
+}
+
+uint32_t EspClass::getCycleCount() {
+  uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - bootTime).count();
+  return (uint32_t)(nanos * getCpuFreqMHz() / 1000);
+}
+
+void EspClass::restart() {
+  Serial.flush();
+  fprintf(stderr, "ESP.restart() called, exiting\n");
+  exit(0);
+}
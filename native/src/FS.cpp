@@ -0,0 +1,262 @@
+#include <FS.h>
+#include <LittleFS.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LittleFSFS LittleFS;
+
+// Same size as the default 1.5 MB littlefs partition
+static const size_t NATIVE_FS_SIZE = 1536 * 1024;
+
+namespace fs {
+
+class FileImpl {
+public:
+  ~FileImpl() { close(); }
+
+  void close() {
+    if (file) fclose(file);
+    if (dir) closedir(dir);
+    file = nullptr;
+    dir = nullptr;
+  }
+
+  FILE* file = nullptr;
+  DIR* dir = nullptr;
+  std::string path;      // Path inside the filesystem, "/config.json"
+  std::string hostPath;  // Where it lives on disk
+  std::string name;
+};
+
+// ---------------------------------------------------------------- File
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!impl || !impl->file) return 0;
+  return fwrite(buf, 1, size, impl->file);
+}
+
+int File::available() {
+  if (!impl || !impl->file) return 0;
+  return (int)(size() - position());
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  if (!impl || !impl->file) return -1;
+  int c = fgetc(impl->file);
+  if (c != EOF) ungetc(c, impl->file);
+  return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+  if (impl && impl->file) fflush(impl->file);
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!impl || !impl->file) return 0;
+  return fread(buf, 1, size, impl->file);
+}
+
+bool File::seek(uint32_t pos) {
+  return impl && impl->file && fseek(impl->file, pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  if (!impl || !impl->file) return 0;
+  long pos = ftell(impl->file);
+  return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+  if (!impl || !impl->file) return 0;
+  fflush(impl->file);
+  struct stat st;
+  return fstat(fileno(impl->file), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+  if (impl) impl->close();
+  impl.reset();
+}
+
+File::operator bool() const {
+  return impl && (impl->file || impl->dir);
+}
+
+time_t File::getLastWrite() {
+  struct stat st;
+  return impl && stat(impl->hostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+const char* File::path() const {
+  return impl ? impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+  return impl ? impl->name.c_str() : nullptr;
+}
+
+bool File::isDirectory() {
+  return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+  if (!impl || !impl->dir) return File();
+  struct dirent* entry;
+  while ((entry = readdir(impl->dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+    std::shared_ptr<FileImpl> child = std::make_shared<FileImpl>();
+    child->path = impl->path == "/" ? "/" + std::string(entry->d_name) : impl->path + "/" + entry->d_name;
+    child->hostPath = impl->hostPath + "/" + entry->d_name;
+    child->name = entry->d_name;
+    struct stat st;
+    if (stat(child->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      child->dir = opendir(child->hostPath.c_str());
+    } else {
+      child->file = fopen(child->hostPath.c_str(), "rb");
+    }
+    if (child->file || child->dir) return File(child);
+  }
+  return File();
+}
+
+void File::rewindDirectory() {
+  if (impl && impl->dir) rewinddir(impl->dir);
+}
+
+// ---------------------------------------------------------------- FS
+
+std::string FS::hostPath(const char* path) const {
+  if (root->empty() || !path || path[0] != '/') return std::string();
+  return *root + path;
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+  std::string host = hostPath(path);
+  if (host.empty()) return File();
+
+  std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+  impl->path = path;
+  impl->hostPath = host;
+  const char* slash = strrchr(path, '/');
+  impl->name = slash ? slash + 1 : path;
+
+  struct stat st;
+  if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    impl->dir = opendir(host.c_str());
+  } else {
+    std::string hostMode = std::string(mode) + "b";
+    impl->file = fopen(host.c_str(), hostMode.c_str());
+  }
+  return (impl->file || impl->dir) ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+  std::string host = hostPath(path);
+  struct stat st;
+  return !host.empty() && stat(host.c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  std::string host = hostPath(path);
+  return !host.empty() && unlink(host.c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  std::string from = hostPath(pathFrom);
+  std::string to = hostPath(pathTo);
+  return !from.empty() && !to.empty() && ::rename(from.c_str(), to.c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  std::string host = hostPath(path);
+  return !host.empty() && (::mkdir(host.c_str(), 0755) == 0 || errno == EEXIST);
+}
+
+bool FS::rmdir(const char* path) {
+  std::string host = hostPath(path);
+  return !host.empty() && ::rmdir(host.c_str()) == 0;
+}
+
+}  // namespace fs
+
+// ---------------------------------------------------------------- LittleFS
+
+static bool ownsRoot = false;
+
+static size_t directoryBytes(const std::string& path, bool removeEntries) {
+  size_t total = 0;
+  DIR* dir = opendir(path.c_str());
+  if (!dir) return 0;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+    std::string child = path + "/" + entry->d_name;
+    struct stat st;
+    if (stat(child.c_str(), &st) != 0) continue;
+    if (S_ISDIR(st.st_mode)) {
+      total += directoryBytes(child, removeEntries);
+      if (removeEntries) rmdir(child.c_str());
+    } else {
+      total += st.st_size;
+      if (removeEntries) unlink(child.c_str());
+    }
+  }
+  closedir(dir);
+  return total;
+}
+
+LittleFSFS::~LittleFSFS() {
+  end();
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+  if (!root->empty()) return true;
+
+  const char* configured = getenv("EASYCONNECT_FS_ROOT");
+  if (configured && *configured) {
+    if (::mkdir(configured, 0755) != 0 && errno != EEXIST) return false;
+    *root = configured;
+    return true;
+  }
+
+  char pattern[] = "/tmp/easyconnect-fs-XXXXXX";
+  if (!mkdtemp(pattern)) return false;
+  *root = pattern;
+  ownsRoot = true;
+  return true;
+}
+
+void LittleFSFS::end() {
+  // A temp dir only lives as long as the mount
+  if (ownsRoot && !root->empty()) {
+    directoryBytes(*root, true);
+    ::rmdir(root->c_str());
+    ownsRoot = false;
+  }
+  root->clear();
+}
+
+bool LittleFSFS::format() {
+  if (root->empty()) return false;
+  directoryBytes(*root, true);
+  return true;
+}
+
+size_t LittleFSFS::totalBytes() {
+  return NATIVE_FS_SIZE;
+}
+
+size_t LittleFSFS::usedBytes() {
+  return root->empty() ? 0 : min(directoryBytes(*root, false), NATIVE_FS_SIZE);
+}
@@ -0,0 +1,241 @@
+#include <freertos/FreeRTOS.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Task {
+  std::string name;
+  TaskFunction_t code;
+  void* parameters;
+  BaseType_t coreId;
+  std::mutex lock;
+  std::condition_variable notified;
+  uint32_t notifications = 0;
+};
+
+struct Queue {
+  std::mutex lock;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t>> items;
+  size_t length;
+  size_t itemSize;
+};
+
+struct Semaphore {
+  std::recursive_timed_mutex lock;
+};
+
+// Thrown by vTaskDelete(NULL) to unwind the task's thread
+struct TaskExit {};
+
+Task mainTask;
+thread_local Task* currentTask = nullptr;
+
+Task* selfTask() {
+  return currentTask ? currentTask : &mainTask;
+}
+
+std::chrono::steady_clock::time_point deadlineFor(TickType_t ticks) {
+  if (ticks == portMAX_DELAY) return std::chrono::steady_clock::time_point::max();
+  return std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks);
+}
+
+template <typename Predicate>
+bool waitUntil(std::unique_lock<std::mutex>& guard, std::condition_variable& cv, TickType_t ticks, Predicate ready) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(guard, ready);
+    return true;
+  }
+  return cv.wait_until(guard, deadlineFor(ticks), ready);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------- port
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+  while (mux->locked.test_and_set(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+  mux->locked.clear(std::memory_order_release);
+}
+
+BaseType_t xPortGetCoreID() {
+  return selfTask() == &mainTask ? APP_CPU_NUM : selfTask()->coreId;
+}
+
+BaseType_t xPortInIsrContext() {
+  return pdFALSE;
+}
+
+// ---------------------------------------------------------------- tasks
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* createdTask, BaseType_t coreId) {
+  Task* task = new Task();
+  task->name = name ? name : "";
+  task->code = code;
+  task->parameters = parameters;
+  task->coreId = coreId == tskNO_AFFINITY ? PRO_CPU_NUM : coreId;
+  if (createdTask) *createdTask = task;
+
+  std::thread([task]() {
+    currentTask = task;
+    try {
+      task->code(task->parameters);
+    } catch (const TaskExit&) {
+    }
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* createdTask) {
+  return xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority, createdTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Only self-deletion is supported: the thread unwinds and exits
+  if (task == nullptr || task == currentTask) {
+    throw TaskExit();
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return selfTask();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  Task* task = selfTask();
+  std::unique_lock<std::mutex> guard(task->lock);
+  waitUntil(guard, task->notified, ticksToWait, [task]() { return task->notifications > 0; });
+  uint32_t count = task->notifications;
+  if (count > 0) task->notifications = clearCountOnExit ? 0 : count - 1;
+  return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+  Task* task = (Task*)handle;
+  {
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notifications++;
+  }
+  task->notified.notify_one();
+  return pdPASS;
+}
+
+// ---------------------------------------------------------------- queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  Queue* queue = new Queue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete (Queue*)queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void* item, TickType_t ticksToWait) {
+  Queue* queue = (Queue*)handle;
+  std::unique_lock<std::mutex> guard(queue->lock);
+  if (!waitUntil(guard, queue->changed, ticksToWait, [queue]() { return queue->items.size() < queue->length; })) {
+    return errQUEUE_FULL;
+  }
+  const uint8_t* bytes = (const uint8_t*)item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  guard.unlock();
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+  return xQueueSend(queue, item, 0);
+}
+
+static BaseType_t queueTake(QueueHandle_t handle, void* buffer, TickType_t ticksToWait, bool remove) {
+  Queue* queue = (Queue*)handle;
+  std::unique_lock<std::mutex> guard(queue->lock);
+  if (!waitUntil(guard, queue->changed, ticksToWait, [queue]() { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(buffer, queue->items.front().data(), queue->itemSize);
+  if (remove) {
+    queue->items.pop_front();
+    guard.unlock();
+    queue->changed.notify_all();
+  }
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+  return queueTake(queue, buffer, ticksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+  return queueTake(queue, buffer, ticksToWait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle) {
+  Queue* queue = (Queue*)handle;
+  std::lock_guard<std::mutex> guard(queue->lock);
+  return (UBaseType_t)queue->items.size();
+}
+
+// ---------------------------------------------------------------- semaphores
+
+// Plain mutexes are recursive too; EasyConnect never relies on self-deadlock
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new Semaphore();
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return new Semaphore();
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete (Semaphore*)semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticksToWait) {
+  Semaphore* semaphore = (Semaphore*)handle;
+  if (ticksToWait == portMAX_DELAY) {
+    semaphore->lock.lock();
+    return pdTRUE;
+  }
+  return semaphore->lock.try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+  ((Semaphore*)handle)->lock.unlock();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  return xSemaphoreTake(semaphore, ticksToWait);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+  return xSemaphoreGive(semaphore);
+}
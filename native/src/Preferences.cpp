@@ -0,0 +1,97 @@
+#include <Preferences.h>
+#include <map>
+#include <mutex>
+
+// NVS limits: 15 character namespaces and keys, 4000 byte strings and blobs
+static const size_t NVS_KEY_MAX = 15;
+static const size_t NVS_VALUE_MAX = 4000;
+
+typedef std::map<std::string, std::string> Namespace;
+
+static std::mutex nvsLock;
+static std::map<std::string, Namespace> nvs;
+
+bool Preferences::begin(const char* name, bool readOnlyMode, const char* partitionLabel) {
+  if (started) return false;
+  if (!name || strlen(name) > NVS_KEY_MAX) return false;
+
+  std::lock_guard<std::mutex> guard(nvsLock);
+  if (readOnlyMode && nvs.find(name) == nvs.end()) {
+    return false;  // NVS cannot open a missing namespace read-only
+  }
+  nvs[name];
+  space = name;
+  readOnly = readOnlyMode;
+  started = true;
+  return true;
+}
+
+void Preferences::end() {
+  started = false;
+}
+
+bool Preferences::clear() {
+  if (!started || readOnly) return false;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  nvs[space].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!started || readOnly || !key) return false;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  return nvs[space].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  std::string value;
+  return findValue(key, value);
+}
+
+size_t Preferences::putValue(const char* key, const void* value, size_t len) {
+  if (!started || readOnly || !key || strlen(key) > NVS_KEY_MAX || len > NVS_VALUE_MAX) return 0;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  nvs[space][key] = std::string((const char*)value, len);
+  return len;
+}
+
+bool Preferences::findValue(const char* key, std::string& value) {
+  if (!started || !key) return false;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  Namespace& entries = nvs[space];
+  Namespace::const_iterator it = entries.find(key);
+  if (it == entries.end()) return false;
+  value = it->second;
+  return true;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+  if (!value) return 0;
+  // Stored with the terminator, as nvs_set_str does
+  return putValue(key, value, strlen(value) + 1) > 0 ? strlen(value) : 0;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+  std::string stored;
+  if (!findValue(key, stored) || !value || stored.size() > maxLen) return 0;
+  memcpy(value, stored.data(), stored.size());
+  return stored.size();
+}
+
+String Preferences::getString(const char* key, String defaultValue) {
+  std::string stored;
+  if (!findValue(key, stored) || stored.empty()) return defaultValue;
+  return String(stored.c_str());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  std::string stored;
+  return findValue(key, stored) ? stored.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  std::string stored;
+  if (!findValue(key, stored) || !buf || stored.size() > maxLen) return 0;
+  memcpy(buf, stored.data(), stored.size());
+  return stored.size();
+}
@@ -0,0 +1,473 @@
+#include <WebServer.h>
+
+// ---------------------------------------------------------------- handlers
+
+class FunctionRequestHandler : public RequestHandler {
+public:
+  FunctionRequestHandler(WebServer::THandlerFunction fn, const String& uri, HTTPMethod method)
+    : _fn(fn), _uri(uri), _method(method) {}
+
+  bool canHandle(HTTPMethod requestMethod, String requestUri) override {
+    if (_method != HTTP_ANY && _method != requestMethod) return false;
+    return requestUri == _uri;
+  }
+
+  bool handle(WebServer& server, HTTPMethod requestMethod, String requestUri) override {
+    if (!canHandle(requestMethod, requestUri)) return false;
+    _fn();
+    return true;
+  }
+
+private:
+  WebServer::THandlerFunction _fn;
+  String _uri;
+  HTTPMethod _method;
+};
+
+StaticRequestHandler::StaticRequestHandler(fs::FS& fs, const char* path, const char* uri, const char* cacheHeader)
+  : _fs(fs), _uri(uri), _path(path), _cacheHeader(cacheHeader ? cacheHeader : "") {
+  _isFile = fs.exists(path) && !fs.open(path).isDirectory();
+  _baseUriLength = _uri.length();
+}
+
+bool StaticRequestHandler::canHandle(HTTPMethod requestMethod, String requestUri) {
+  if (requestMethod != HTTP_GET) return false;
+  if (_isFile ? requestUri != _uri : !requestUri.startsWith(_uri)) return false;
+  return true;
+}
+
+bool StaticRequestHandler::handle(WebServer& server, HTTPMethod requestMethod, String requestUri) {
+  if (!canHandle(requestMethod, requestUri)) return false;
+
+  String path(_path);
+  if (!_isFile) {
+    if (requestUri.endsWith("/")) requestUri += _defaultFile;
+    path += requestUri.substring(_baseUriLength);
+    if (path.startsWith("//")) path.remove(0, 1);
+  }
+
+  String contentType = getContentType(path);
+  // Prefer a precompressed copy next to the file
+  if (!path.endsWith(".gz") && !_fs.exists(path)) {
+    String gzipped = path + ".gz";
+    if (_fs.exists(gzipped)) path = gzipped;
+  }
+
+  File f = _fs.open(path, "r");
+  if (!f || f.isDirectory()) return false;
+  if (_cacheHeader.length() != 0) server.sendHeader("Cache-Control", _cacheHeader);
+  server.streamFile(f, contentType);
+  return true;
+}
+
+String StaticRequestHandler::getContentType(const String& path) {
+  if (path.endsWith(".html") || path.endsWith(".htm")) return "text/html";
+  if (path.endsWith(".css")) return "text/css";
+  if (path.endsWith(".js")) return "application/javascript";
+  if (path.endsWith(".json")) return "application/json";
+  if (path.endsWith(".png")) return "image/png";
+  if (path.endsWith(".svg")) return "image/svg+xml";
+  if (path.endsWith(".ico")) return "image/x-icon";
+  if (path.endsWith(".txt")) return "text/plain";
+  if (path.endsWith(".gz")) return "application/x-gzip";
+  return "application/octet-stream";
+}
+
+// ---------------------------------------------------------------- server
+
+WebServer::WebServer(int port) : _server(port) {}
+
+WebServer::~WebServer() {
+  close();
+  RequestHandler* handler = _firstHandler;
+  while (handler) {
+    RequestHandler* next = handler->next();
+    delete handler;
+    handler = next;
+  }
+}
+
+void WebServer::begin() {
+  close();
+  _server.begin();
+  _server.setNoDelay(true);
+}
+
+void WebServer::begin(uint16_t port) {
+  close();
+  _server.begin(port);
+  _server.setNoDelay(true);
+}
+
+void WebServer::close() {
+  _server.close();
+  _currentStatus = HC_NONE;
+}
+
+WebServer& WebServer::on(const String& uri, THandlerFunction fn) {
+  return on(uri, HTTP_ANY, fn);
+}
+
+WebServer& WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn) {
+  _addRequestHandler(new FunctionRequestHandler(fn, uri, method));
+  return *this;
+}
+
+WebServer& WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) {
+  return on(uri, method, fn);
+}
+
+void WebServer::addHandler(RequestHandler* handler) {
+  _addRequestHandler(handler);
+}
+
+StaticRequestHandler& WebServer::serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheHeader) {
+  StaticRequestHandler* handler = new StaticRequestHandler(fs, path, uri, cacheHeader);
+  _addRequestHandler(handler);
+  return *handler;
+}
+
+void WebServer::_addRequestHandler(RequestHandler* handler) {
+  if (!_lastHandler) {
+    _firstHandler = handler;
+    _lastHandler = handler;
+  } else {
+    _lastHandler->next(handler);
+    _lastHandler = handler;
+  }
+}
+
+// Same state machine as the ESP32 core: one client at a time, read the
+// request, answer, then wait for the peer to close
+void WebServer::handleClient() {
+  if (_currentStatus == HC_NONE) {
+    WiFiClient client = _server.available();
+    if (!client) return;
+    _currentClient = client;
+    _currentStatus = HC_WAIT_READ;
+    _statusChange = millis();
+  }
+
+  bool keepCurrentClient = false;
+  if (_currentClient.connected()) {
+    switch (_currentStatus) {
+      case HC_NONE:
+        break;
+      case HC_WAIT_READ:
+        if (_currentClient.available()) {
+          if (_parseRequest(_currentClient)) {
+            _currentClient.setTimeout(HTTP_MAX_DATA_WAIT / 1000);
+            _contentLength = CONTENT_LENGTH_NOT_SET;
+            _handleRequest();
+            if (_currentClient.connected()) {
+              _currentStatus = HC_WAIT_CLOSE;
+              _statusChange = millis();
+              keepCurrentClient = true;
+            }
+          }
+        } else if (millis() - _statusChange <= HTTP_MAX_DATA_WAIT) {
+          keepCurrentClient = true;
+        }
+        break;
+      case HC_WAIT_CLOSE:
+        if (millis() - _statusChange <= HTTP_MAX_CLOSE_WAIT) keepCurrentClient = true;
+        break;
+    }
+  }
+
+  if (!keepCurrentClient) {
+    _currentClient = WiFiClient();
+    _currentStatus = HC_NONE;
+  }
+}
+
+static HTTPMethod parseMethod(const String& method) {
+  if (method == "GET") return HTTP_GET;
+  if (method == "POST") return HTTP_POST;
+  if (method == "PUT") return HTTP_PUT;
+  if (method == "PATCH") return HTTP_PATCH;
+  if (method == "DELETE") return HTTP_DELETE;
+  if (method == "OPTIONS") return HTTP_OPTIONS;
+  if (method == "HEAD") return HTTP_HEAD;
+  return HTTP_ANY;
+}
+
+bool WebServer::_parseRequest(WiFiClient& client) {
+  String req = client.readStringUntil('\r');
+  client.readStringUntil('\n');
+  _currentArgs.clear();
+  _currentHeaders.clear();
+  _hostHeader = String();
+
+  int addrStart = req.indexOf(' ');
+  int addrEnd = req.indexOf(' ', addrStart + 1);
+  if (addrStart == -1 || addrEnd == -1) return false;
+
+  String methodStr = req.substring(0, addrStart);
+  String url = req.substring(addrStart + 1, addrEnd);
+  String versionEnd = req.substring(addrEnd + 8);
+  _currentVersion = atoi(versionEnd.c_str());
+  String searchStr;
+  int hasSearch = url.indexOf('?');
+  if (hasSearch != -1) {
+    searchStr = url.substring(hasSearch + 1);
+    url = url.substring(0, hasSearch);
+  }
+  _currentUri = url;
+  _currentMethod = parseMethod(methodStr);
+
+  // Headers
+  String contentType;
+  size_t contentLength = 0;
+  while (true) {
+    req = client.readStringUntil('\r');
+    client.readStringUntil('\n');
+    if (req.isEmpty()) break;
+    int headerDiv = req.indexOf(':');
+    if (headerDiv == -1) break;
+    String headerName = req.substring(0, headerDiv);
+    String headerValue = req.substring(headerDiv + 1);
+    headerValue.trim();
+
+    for (size_t i = 0; i < _collectedHeaderKeys.size(); i++) {
+      if (_collectedHeaderKeys[i].equalsIgnoreCase(headerName)) {
+        RequestArgument header = {headerName, headerValue};
+        _currentHeaders.push_back(header);
+      }
+    }
+    if (headerName.equalsIgnoreCase("Content-Type")) contentType = headerValue;
+    else if (headerName.equalsIgnoreCase("Content-Length")) contentLength = headerValue.toInt();
+    else if (headerName.equalsIgnoreCase("Host")) _hostHeader = headerValue;
+  }
+
+  // Body: url-encoded forms become arguments, anything else is "plain"
+  String body;
+  if (contentLength > 0) {
+    if (contentLength > HTTP_MAX_BODY) return false;
+    std::unique_ptr<char[]> buf(new char[contentLength + 1]);
+    client.setTimeout(HTTP_MAX_POST_WAIT / 1000);
+    size_t got = client.readBytes(buf.get(), contentLength);
+    buf[got] = '\0';
+    body = String(buf.get(), got);
+  }
+  bool isEncoded = contentType.startsWith("application/x-www-form-urlencoded");
+  if (isEncoded && body.length() > 0) {
+    if (searchStr.length() > 0) searchStr += '&';
+    searchStr += body;
+  }
+  _parseArguments(searchStr);
+  if (!isEncoded && contentLength > 0) {
+    RequestArgument plain = {"plain", body};
+    _currentArgs.push_back(plain);
+  }
+  return true;
+}
+
+void WebServer::_parseArguments(const String& data) {
+  unsigned int pos = 0;
+  while (pos < data.length()) {
+    int next = data.indexOf('&', pos);
+    unsigned int end = next == -1 ? data.length() : (unsigned int)next;
+    String pair = data.substring(pos, end);
+    if (pair.length() > 0) {
+      int eq = pair.indexOf('=');
+      RequestArgument arg;
+      arg.key = urlDecode(eq == -1 ? pair : pair.substring(0, eq));
+      arg.value = eq == -1 ? String() : urlDecode(pair.substring(eq + 1));
+      _currentArgs.push_back(arg);
+    }
+    pos = end + 1;
+  }
+}
+
+String WebServer::urlDecode(const String& text) {
+  String decoded;
+  decoded.reserve(text.length());
+  for (unsigned int i = 0; i < text.length(); i++) {
+    char c = text[i];
+    if (c == '+') {
+      decoded += ' ';
+    } else if (c == '%' && i + 2 < text.length()) {
+      char hex[3] = {text[i + 1], text[i + 2], 0};
+      decoded += (char)strtol(hex, nullptr, 16);
+      i += 2;
+    } else {
+      decoded += c;
+    }
+  }
+  return decoded;
+}
+
+void WebServer::_handleRequest() {
+  bool handled = false;
+  for (_currentHandler = _firstHandler; _currentHandler; _currentHandler = _currentHandler->next()) {
+    if (_currentHandler->canHandle(_currentMethod, _currentUri) &&
+        _currentHandler->handle(*this, _currentMethod, _currentUri)) {
+      handled = true;
+      break;
+    }
+  }
+  if (!handled && _notFoundHandler) {
+    _notFoundHandler();
+    handled = true;
+  }
+  if (!handled) {
+    send(404, "text/plain", String("Not found: ") + _currentUri);
+  }
+  _finalizeResponse();
+  _currentUri = String();
+}
+
+void WebServer::_finalizeResponse() {
+  if (_chunked) sendContent("");
+}
+
+// ---------------------------------------------------------------- request
+
+String WebServer::arg(const String& name) {
+  for (size_t i = 0; i < _currentArgs.size(); i++) {
+    if (_currentArgs[i].key == name) return _currentArgs[i].value;
+  }
+  return String();
+}
+
+String WebServer::arg(int i) {
+  return i >= 0 && i < args() ? _currentArgs[i].value : String();
+}
+
+String WebServer::argName(int i) {
+  return i >= 0 && i < args() ? _currentArgs[i].key : String();
+}
+
+bool WebServer::hasArg(const String& name) {
+  for (size_t i = 0; i < _currentArgs.size(); i++) {
+    if (_currentArgs[i].key == name) return true;
+  }
+  return false;
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+  _collectedHeaderKeys.clear();
+  for (size_t i = 0; i < headerKeysCount; i++) _collectedHeaderKeys.push_back(headerKeys[i]);
+}
+
+String WebServer::header(const String& name) {
+  for (size_t i = 0; i < _currentHeaders.size(); i++) {
+    if (_currentHeaders[i].key.equalsIgnoreCase(name)) return _currentHeaders[i].value;
+  }
+  return String();
+}
+
+String WebServer::header(int i) {
+  return i >= 0 && i < headers() ? _currentHeaders[i].value : String();
+}
+
+String WebServer::headerName(int i) {
+  return i >= 0 && i < headers() ? _currentHeaders[i].key : String();
+}
+
+bool WebServer::hasHeader(const String& name) {
+  for (size_t i = 0; i < _currentHeaders.size(); i++) {
+    if (_currentHeaders[i].key.equalsIgnoreCase(name)) return true;
+  }
+  return false;
+}
+
+// ---------------------------------------------------------------- response
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  String headerLine = name + ": " + value + "\r\n";
+  if (first) _responseHeaders = headerLine + _responseHeaders;
+  else _responseHeaders += headerLine;
+}
+
+void WebServer::_prepareHeader(String& response, int code, const char* contentType, size_t contentLength) {
+  response = String("HTTP/1.") + String(_currentVersion) + " " + String(code) + " " + _responseCodeToString(code) + "\r\n";
+
+  if (!contentType) contentType = "text/html";
+  sendHeader("Content-Type", contentType, true);
+  if (_contentLength == CONTENT_LENGTH_NOT_SET) {
+    sendHeader("Content-Length", String((unsigned long)contentLength));
+  } else if (_contentLength != CONTENT_LENGTH_UNKNOWN) {
+    sendHeader("Content-Length", String((unsigned long)_contentLength));
+  } else if (_currentVersion) {
+    _chunked = true;
+    sendHeader("Accept-Ranges", "none");
+    sendHeader("Transfer-Encoding", "chunked");
+  }
+  sendHeader("Connection", "close");
+
+  response += _responseHeaders;
+  response += "\r\n";
+  _responseHeaders = String();
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  String header;
+  _prepareHeader(header, code, contentType, content.length());
+  _currentClient.write((const uint8_t*)header.c_str(), header.length());
+  if (content.length()) sendContent(content);
+}
+
+void WebServer::send(int code, const char* contentType, const char* content) {
+  send(code, contentType, String(content ? content : ""));
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content) {
+  send_P(code, contentType, content, content ? strlen(content) : 0);
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength) {
+  String header;
+  _prepareHeader(header, code, contentType, contentLength);
+  _currentClient.write((const uint8_t*)header.c_str(), header.length());
+  if (contentLength) sendContent(content, contentLength);
+}
+
+void WebServer::sendContent(const char* content, size_t contentLength) {
+  static const char footer[] = "\r\n";
+  if (_chunked) {
+    char chunkSize[11];
+    int n = snprintf(chunkSize, sizeof(chunkSize), "%zx\r\n", contentLength);
+    _currentClient.write((const uint8_t*)chunkSize, n);
+  }
+  _currentClient.write((const uint8_t*)content, contentLength);
+  if (_chunked) {
+    _currentClient.write((const uint8_t*)footer, 2);
+    if (contentLength == 0) _chunked = false;
+  }
+}
+
+void WebServer::_streamFileCore(const size_t fileSize, const String& fileName, const String& contentType, const int code) {
+  setContentLength(fileSize);
+  if (fileName.endsWith(".gz") && contentType != "application/x-gzip" && contentType != "application/octet-stream") {
+    sendHeader("Content-Encoding", "gzip");
+  }
+  send(code, contentType, "");
+}
+
+const char* WebServer::_responseCodeToString(int code) {
+  switch (code) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 406: return "Not Acceptable";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
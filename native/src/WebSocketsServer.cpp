@@ -0,0 +1,411 @@
+#include <WebSocketsServer.h>
+
+static const char WEBSOCKET_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// ---------------------------------------------------------------- SHA-1 / base64
+
+static uint32_t rotl(uint32_t x, int n) {
+  return (x << n) | (x >> (32 - n));
+}
+
+static void sha1(const uint8_t* data, size_t length, uint8_t digest[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  size_t paddedLength = ((length + 8) / 64 + 1) * 64;
+  std::vector<uint8_t> msg(paddedLength, 0);
+  memcpy(msg.data(), data, length);
+  msg[length] = 0x80;
+  uint64_t bits = (uint64_t)length * 8;
+  for (int i = 0; i < 8; i++) msg[paddedLength - 1 - i] = (uint8_t)(bits >> (8 * i));
+
+  for (size_t chunk = 0; chunk < paddedLength; chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* p = &msg[chunk + i * 4];
+      w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+    for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+      else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+      else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+      else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+      uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = temp;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  for (int i = 0; i < 5; i++) {
+    digest[i * 4] = (uint8_t)(h[i] >> 24);
+    digest[i * 4 + 1] = (uint8_t)(h[i] >> 16);
+    digest[i * 4 + 2] = (uint8_t)(h[i] >> 8);
+    digest[i * 4 + 3] = (uint8_t)h[i];
+  }
+}
+
+static String base64(const uint8_t* data, size_t length) {
+  static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  String out;
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t n = (uint32_t)data[i] << 16;
+    if (i + 1 < length) n |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < length) n |= data[i + 2];
+    out += table[(n >> 18) & 63];
+    out += table[(n >> 12) & 63];
+    out += i + 1 < length ? table[(n >> 6) & 63] : '=';
+    out += i + 2 < length ? table[n & 63] : '=';
+  }
+  return out;
+}
+
+// ---------------------------------------------------------------- server
+
+WebSocketsServer::WebSocketsServer(uint16_t port, const String& origin, const String& protocol)
+  : _port(port), _origin(origin), _protocol(protocol), _server(new WiFiServer(port)) {
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    _clients[i].num = i;
+    _clients[i].status = WSC_NOT_CONNECTED;
+    _clients[i].tcp = nullptr;
+  }
+}
+
+WebSocketsServer::~WebSocketsServer() {
+  close();
+  delete _server;
+}
+
+void WebSocketsServer::begin() {
+  _server->begin();
+}
+
+void WebSocketsServer::close() {
+  disconnect();
+  _server->close();
+}
+
+void WebSocketsServer::loop() {
+  handleNewClients();
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    WSclient_t* client = &_clients[i];
+    if (client->status == WSC_NOT_CONNECTED) continue;
+    if (!client->tcp->connected()) {
+      clientDisconnect(client);
+      continue;
+    }
+    if (client->status == WSC_HEADER) handleHeader(client);
+    else if (client->status == WSC_CONNECTED) handleFrames(client);
+  }
+}
+
+void WebSocketsServer::handleNewClients() {
+  while (_server->hasClient()) {
+    WiFiClient tcp = _server->accept();
+    WSclient_t* slot = nullptr;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX && !slot; i++) {
+      if (_clients[i].status == WSC_NOT_CONNECTED) slot = &_clients[i];
+    }
+    if (!slot) {
+      tcp.stop();  // No free slot, same as the library
+      continue;
+    }
+    slot->tcp = new WiFiClient(tcp);
+    slot->tcp->setNoDelay(true);
+    slot->status = WSC_HEADER;
+    slot->cUrl = String();
+    slot->cKey = String();
+    slot->cHeader = String();
+    slot->rx.clear();
+    slot->fragment.clear();
+  }
+}
+
+void WebSocketsServer::handleHeader(WSclient_t* client) {
+  uint8_t buf[512];
+  int n;
+  while ((n = client->tcp->read(buf, sizeof(buf))) > 0) {
+    client->cHeader.concat((const char*)buf, n);
+  }
+  int end = client->cHeader.indexOf("\r\n\r\n");
+  if (end < 0) {
+    if (client->cHeader.length() > 4096) clientDisconnect(client);
+    return;
+  }
+
+  String request = client->cHeader.substring(0, end);
+  client->cHeader = String();
+  int lineEnd = request.indexOf("\r\n");
+  String requestLine = request.substring(0, lineEnd < 0 ? request.length() : lineEnd);
+  int urlStart = requestLine.indexOf(' ');
+  int urlEnd = requestLine.indexOf(' ', urlStart + 1);
+  if (!requestLine.startsWith("GET ") || urlEnd < 0) {
+    clientDisconnect(client);
+    return;
+  }
+  client->cUrl = requestLine.substring(urlStart + 1, urlEnd);
+
+  bool upgrade = false;
+  unsigned int pos = lineEnd < 0 ? request.length() : lineEnd + 2;
+  while (pos < request.length()) {
+    int next = request.indexOf("\r\n", pos);
+    String line = request.substring(pos, next < 0 ? request.length() : next);
+    pos = next < 0 ? request.length() : next + 2;
+    int colon = line.indexOf(':');
+    if (colon < 0) continue;
+    String name = line.substring(0, colon);
+    String value = line.substring(colon + 1);
+    value.trim();
+    if (name.equalsIgnoreCase("Upgrade")) {
+      value.toLowerCase();
+      upgrade = value == "websocket";
+    } else if (name.equalsIgnoreCase("Sec-WebSocket-Key")) {
+      client->cKey = value;
+    }
+  }
+
+  if (!upgrade || client->cKey.length() == 0) {
+    const char* reply = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+    client->tcp->write((const uint8_t*)reply, strlen(reply));
+    clientDisconnect(client);
+    return;
+  }
+
+  String keyed = client->cKey + WEBSOCKET_GUID;
+  uint8_t digest[20];
+  sha1((const uint8_t*)keyed.c_str(), keyed.length(), digest);
+  String response = "HTTP/1.1 101 Switching Protocols\r\n"
+                    "Server: arduino-WebSocketsServer\r\n"
+                    "Upgrade: websocket\r\n"
+                    "Connection: Upgrade\r\n"
+                    "Sec-WebSocket-Version: 13\r\n"
+                    "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+  client->tcp->write((const uint8_t*)response.c_str(), response.length());
+  client->status = WSC_CONNECTED;
+
+  runCbEvent(client->num, WStype_CONNECTED, (uint8_t*)client->cUrl.c_str(), client->cUrl.length());
+}
+
+void WebSocketsServer::handleFrames(WSclient_t* client) {
+  uint8_t buf[1436];
+  int n;
+  while ((n = client->tcp->read(buf, sizeof(buf))) > 0) {
+    client->rx.insert(client->rx.end(), buf, buf + n);
+  }
+
+  size_t offset = 0;
+  while (client->status == WSC_CONNECTED) {
+    std::vector<uint8_t>& rx = client->rx;
+    size_t avail = rx.size() - offset;
+    if (avail < 2) break;
+    const uint8_t* h = rx.data() + offset;
+    bool fin = h[0] & 0x80;
+    WSopcode_t opcode = (WSopcode_t)(h[0] & 0x0F);
+    bool masked = h[1] & 0x80;
+    uint64_t length = h[1] & 0x7F;
+    size_t headerLength = 2;
+    if (length == 126) {
+      if (avail < 4) break;
+      length = ((uint64_t)h[2] << 8) | h[3];
+      headerLength = 4;
+    } else if (length == 127) {
+      if (avail < 10) break;
+      length = 0;
+      for (int i = 0; i < 8; i++) length = (length << 8) | h[2 + i];
+      headerLength = 10;
+    }
+    // Clients must mask; oversized frames are dropped with the connection
+    if (!masked || length > WEBSOCKETS_MAX_DATA_SIZE) {
+      clientDisconnect(client);
+      return;
+    }
+    if (avail < headerLength + 4 + length) break;
+
+    const uint8_t* mask = h + headerLength;
+    uint8_t* payload = rx.data() + offset + headerLength + 4;
+    for (uint64_t i = 0; i < length; i++) payload[i] ^= mask[i & 3];
+    offset += headerLength + 4 + (size_t)length;
+
+    switch (opcode) {
+      case WSop_text:
+      case WSop_binary:
+      case WSop_continuation: {
+        if (opcode != WSop_continuation) {
+          client->fragment.clear();
+          client->fragmentOpcode = opcode;
+        }
+        client->fragment.insert(client->fragment.end(), payload, payload + length);
+        if (!fin) break;
+        size_t messageLength = client->fragment.size();
+        client->fragment.push_back(0);  // Text payloads arrive NUL terminated
+        runCbEvent(client->num, client->fragmentOpcode == WSop_text ? WStype_TEXT : WStype_BIN,
+                   client->fragment.data(), messageLength);
+        client->fragment.clear();
+        break;
+      }
+      case WSop_ping:
+        sendFrame(client, WSop_pong, payload, (size_t)length);
+        runCbEvent(client->num, WStype_PING, payload, (size_t)length);
+        break;
+      case WSop_pong:
+        runCbEvent(client->num, WStype_PONG, payload, (size_t)length);
+        break;
+      case WSop_close:
+        sendFrame(client, WSop_close, payload, min((size_t)length, (size_t)2));
+        clientDisconnect(client);
+        return;
+    }
+  }
+  if (client->status == WSC_CONNECTED) client->rx.erase(client->rx.begin(), client->rx.begin() + offset);
+}
+
+void WebSocketsServer::clientDisconnect(WSclient_t* client) {
+  bool wasConnected = client->status == WSC_CONNECTED;
+  if (client->tcp) {
+    client->tcp->stop();
+    delete client->tcp;
+    client->tcp = nullptr;
+  }
+  client->status = WSC_NOT_CONNECTED;
+  client->cUrl = String();
+  client->cKey = String();
+  client->cHeader = String();
+  client->rx.clear();
+  client->fragment.clear();
+  if (wasConnected) runCbEvent(client->num, WStype_DISCONNECTED, nullptr, 0);
+}
+
+bool WebSocketsServer::sendFrame(WSclient_t* client, WSopcode_t opcode, const uint8_t* payload, size_t length) {
+  if (!clientIsConnected(client)) return false;
+  uint8_t header[WEBSOCKETS_MAX_HEADER_SIZE];
+  size_t headerLength = 2;
+  header[0] = 0x80 | opcode;
+  if (length < 126) {
+    header[1] = (uint8_t)length;
+  } else if (length <= 0xFFFF) {
+    header[1] = 126;
+    header[2] = (uint8_t)(length >> 8);
+    header[3] = (uint8_t)length;
+    headerLength = 4;
+  } else {
+    header[1] = 127;
+    for (int i = 0; i < 8; i++) header[2 + i] = (uint8_t)((uint64_t)length >> (8 * (7 - i)));
+    headerLength = 10;
+  }
+  if (client->tcp->write(header, headerLength) != headerLength) return false;
+  return length == 0 || client->tcp->write(payload, length) == length;
+}
+
+bool WebSocketsServer::clientIsConnected(WSclient_t* client) {
+  return client->tcp && client->status == WSC_CONNECTED && client->tcp->connected();
+}
+
+// ---------------------------------------------------------------- public API
+
+bool WebSocketsServer::sendTXT(uint8_t num, uint8_t* payload, size_t length, bool headerToPayload) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  if (length == 0) length = strlen((const char*)payload);
+  return sendFrame(&_clients[num], WSop_text, payload, length);
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const uint8_t* payload, size_t length) {
+  return sendTXT(num, (uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, char* payload, size_t length, bool headerToPayload) {
+  return sendTXT(num, (uint8_t*)payload, length, headerToPayload);
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const char* payload, size_t length) {
+  return sendTXT(num, (uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, String& payload) {
+  return sendTXT(num, (uint8_t*)payload.c_str(), payload.length());
+}
+
+bool WebSocketsServer::broadcastTXT(uint8_t* payload, size_t length, bool headerToPayload) {
+  if (length == 0) length = strlen((const char*)payload);
+  bool ret = true;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clientIsConnected(&_clients[i]) && !sendFrame(&_clients[i], WSop_text, payload, length)) ret = false;
+  }
+  return ret;
+}
+
+bool WebSocketsServer::broadcastTXT(const uint8_t* payload, size_t length) {
+  return broadcastTXT((uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::broadcastTXT(char* payload, size_t length, bool headerToPayload) {
+  return broadcastTXT((uint8_t*)payload, length, headerToPayload);
+}
+
+bool WebSocketsServer::broadcastTXT(const char* payload, size_t length) {
+  return broadcastTXT((uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::broadcastTXT(String& payload) {
+  return broadcastTXT((uint8_t*)payload.c_str(), payload.length());
+}
+
+bool WebSocketsServer::sendBIN(uint8_t num, uint8_t* payload, size_t length, bool headerToPayload) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  return sendFrame(&_clients[num], WSop_binary, payload, length);
+}
+
+bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t* payload, size_t length) {
+  return sendBIN(num, (uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::broadcastBIN(uint8_t* payload, size_t length, bool headerToPayload) {
+  bool ret = true;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clientIsConnected(&_clients[i]) && !sendFrame(&_clients[i], WSop_binary, payload, length)) ret = false;
+  }
+  return ret;
+}
+
+bool WebSocketsServer::broadcastBIN(const uint8_t* payload, size_t length) {
+  return broadcastBIN((uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::sendPing(uint8_t num, uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  return sendFrame(&_clients[num], WSop_ping, payload, length);
+}
+
+void WebSocketsServer::disconnect() {
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) disconnect(i);
+}
+
+void WebSocketsServer::disconnect(uint8_t num) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || _clients[num].status == WSC_NOT_CONNECTED) return;
+  if (_clients[num].status == WSC_CONNECTED) sendFrame(&_clients[num], WSop_close, nullptr, 0);
+  clientDisconnect(&_clients[num]);
+}
+
+uint8_t WebSocketsServer::connectedClients(bool ping) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clientIsConnected(&_clients[i])) count++;
+  }
+  return count;
+}
+
+bool WebSocketsServer::clientIsConnected(uint8_t num) {
+  return num < WEBSOCKETS_SERVER_CLIENT_MAX && clientIsConnected(&_clients[num]);
+}
+
+IPAddress WebSocketsServer::remoteIP(uint8_t num) {
+  if (!clientIsConnected(num)) return IPAddress();
+  return _clients[num].tcp->remoteIP();
+}
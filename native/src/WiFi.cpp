@@ -0,0 +1,418 @@
+#include <WiFi.h>
+#include <mutex>
+#include <thread>
+
+WiFiClass WiFi;
+
+uint16_t nativePort(uint16_t devicePort) {
+  static const long offset = getenv("EASYCONNECT_PORT_OFFSET") ? atol(getenv("EASYCONNECT_PORT_OFFSET")) : 8000;
+  return (uint16_t)(devicePort + offset);
+}
+
+// ---------------------------------------------------------------- WiFiClient
+
+// One TCP connection shared by every WiFiClient copy, with the same
+// receive buffer the ESP32 core keeps in front of the socket
+class WiFiClientSocket {
+public:
+  static const size_t RX_BUFFER_SIZE = 1436;
+
+  explicit WiFiClientSocket(int fd) : fd(fd) {}
+  ~WiFiClientSocket() { close(); }
+
+  void close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+
+  size_t buffered() const { return fill - pos; }
+
+  bool refill() {
+    if (fd < 0 || failed) return false;
+    pos = fill = 0;
+    ssize_t n = recv(fd, rx, sizeof(rx), MSG_DONTWAIT);
+    if (n > 0) {
+      fill = n;
+      return true;
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) failed = true;
+    return false;
+  }
+
+  int fd;
+  bool failed = false;
+  uint8_t rx[RX_BUFFER_SIZE];
+  size_t pos = 0;
+  size_t fill = 0;
+};
+
+WiFiClient::WiFiClient() {}
+
+WiFiClient::WiFiClient(int fd) : socket(std::make_shared<WiFiClientSocket>(fd)) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  int enable = 1;
+  setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  stop();
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = (uint32_t)ip;
+  if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    ::close(fd);
+    return 0;
+  }
+  *this = WiFiClient(fd);
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  IPAddress ip;
+  if (strcmp(host, "localhost") == 0) ip = IPAddress(127, 0, 0, 1);
+  else if (!ip.fromString(host)) return 0;
+  return connect(ip, port);
+}
+
+size_t WiFiClient::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (!socket || socket->fd < 0) return 0;
+  // Like the ESP32 core: wait for send room, give up after ten stalled rounds
+  size_t sent = 0;
+  int retries = 10;
+  while (sent < size && retries > 0) {
+    ssize_t n = send(socket->fd, buf + sent, size - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += n;
+      retries = 10;
+      continue;
+    }
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      stop();
+      break;
+    }
+    struct pollfd pfd = {socket->fd, POLLOUT, 0};
+    if (poll(&pfd, 1, 1000) <= 0) retries--;
+  }
+  return sent;
+}
+
+size_t WiFiClient::write(Stream& stream) {
+  uint8_t buf[WiFiClientSocket::RX_BUFFER_SIZE];
+  size_t total = 0;
+  while (stream.available() > 0) {
+    size_t n = stream.readBytes(buf, sizeof(buf));
+    if (n == 0) break;
+    size_t sent = write(buf, n);
+    total += sent;
+    if (sent < n) break;
+  }
+  return total;
+}
+
+int WiFiClient::available() {
+  if (!socket || socket->fd < 0) return 0;
+  int pending = 0;
+  if (ioctl(socket->fd, FIONREAD, &pending) < 0) pending = 0;
+  return (int)socket->buffered() + pending;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  if (!socket) return -1;
+  size_t copied = 0;
+  while (copied < size) {
+    if (socket->buffered() == 0 && !socket->refill()) break;
+    size_t n = min(size - copied, socket->buffered());
+    memcpy(buf + copied, socket->rx + socket->pos, n);
+    socket->pos += n;
+    copied += n;
+  }
+  return copied > 0 ? (int)copied : -1;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::peek() {
+  if (!socket) return -1;
+  if (socket->buffered() == 0 && !socket->refill()) return -1;
+  return socket->rx[socket->pos];
+}
+
+void WiFiClient::stop() {
+  if (socket) socket->close();
+  socket.reset();
+}
+
+uint8_t WiFiClient::connected() {
+  if (!socket || socket->fd < 0) return 0;
+  if (socket->buffered() > 0) return 1;
+  if (socket->failed) return 0;
+  uint8_t probe;
+  ssize_t n = recv(socket->fd, &probe, 1, MSG_DONTWAIT | MSG_PEEK);
+  if (n > 0) return 1;
+  if (n == 0) return 0;
+  return errno == EAGAIN || errno == EWOULDBLOCK ? 1 : 0;
+}
+
+static IPAddress socketAddress(int fd, bool peer, uint16_t* port) {
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  memset(&addr, 0, sizeof(addr));
+  if (fd >= 0) {
+    if (peer) getpeername(fd, (struct sockaddr*)&addr, &len);
+    else getsockname(fd, (struct sockaddr*)&addr, &len);
+  }
+  if (port) *port = ntohs(addr.sin_port);
+  return IPAddress((uint32_t)addr.sin_addr.s_addr);
+}
+
+IPAddress WiFiClient::remoteIP() const {
+  return socketAddress(fd(), true, nullptr);
+}
+
+uint16_t WiFiClient::remotePort() const {
+  uint16_t port;
+  socketAddress(fd(), true, &port);
+  return port;
+}
+
+IPAddress WiFiClient::localIP() const {
+  return socketAddress(fd(), false, nullptr);
+}
+
+uint16_t WiFiClient::localPort() const {
+  uint16_t port;
+  socketAddress(fd(), false, &port);
+  return port;
+}
+
+int WiFiClient::fd() const {
+  return socket ? socket->fd : -1;
+}
+
+int WiFiClient::setNoDelay(bool nodelay) {
+  int flag = nodelay;
+  return setsockopt(fd(), IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+// ---------------------------------------------------------------- WiFiServer
+
+WiFiServer::WiFiServer(uint16_t port, uint8_t maxClients)
+  : sockfd(-1), acceptedSockfd(-1), port(port), maxClients(maxClients), listening(false), noDelay(false) {}
+
+void WiFiServer::begin(uint16_t newPort) {
+  if (listening) return;
+  if (newPort) port = newPort;
+
+  sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (sockfd < 0) return;
+  int enable = 1;
+  setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(nativePort(port));
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(sockfd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(sockfd, maxClients) < 0) {
+    fprintf(stderr, "WiFiServer: cannot listen on 127.0.0.1:%u (%s)\n", nativePort(port), strerror(errno));
+    ::close(sockfd);
+    sockfd = -1;
+    return;
+  }
+  fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL) | O_NONBLOCK);
+  listening = true;
+}
+
+bool WiFiServer::hasClient() {
+  if (acceptedSockfd >= 0) return true;
+  if (!listening) return false;
+  acceptedSockfd = ::accept(sockfd, nullptr, nullptr);
+  return acceptedSockfd >= 0;
+}
+
+WiFiClient WiFiServer::accept() {
+  if (!hasClient()) return WiFiClient();
+  int fd = acceptedSockfd;
+  acceptedSockfd = -1;
+  WiFiClient client(fd);
+  if (noDelay) client.setNoDelay(true);
+  return client;
+}
+
+void WiFiServer::end() {
+  if (acceptedSockfd >= 0) ::close(acceptedSockfd);
+  if (sockfd >= 0) ::close(sockfd);
+  acceptedSockfd = sockfd = -1;
+  listening = false;
+}
+
+// ---------------------------------------------------------------- WiFiClass
+
+static std::recursive_mutex eventLock;
+
+static const uint8_t nativeBssid[6] = {0x02, 0x00, 0x00, 0xEC, 0x00, 0xAA};
+
+struct ScanEntry {
+  const char* ssid;
+  int32_t rssi;
+  int32_t channel;
+  wifi_auth_mode_t auth;
+};
+
+static const ScanEntry scanEntries[] = {
+  {"EasyConnect-Native", -52, 6, WIFI_AUTH_WPA2_PSK},
+  {"Neighbour", -71, 1, WIFI_AUTH_WPA2_PSK},
+  {"CoffeeShop", -83, 11, WIFI_AUTH_OPEN},
+};
+static const int16_t SCAN_COUNT = sizeof(scanEntries) / sizeof(scanEntries[0]);
+static const unsigned long SCAN_DURATION_MS = 120;
+
+wl_status_t WiFiClass::begin(const char* newSsid, const char* newPassphrase, int32_t channel,
+                             const uint8_t* bssid, bool connect) {
+  if (newSsid && *newSsid) ssid = newSsid;
+  passphrase = newPassphrase ? newPassphrase : "";
+  if (connect) connectLater();
+  return linkStatus;
+}
+
+wl_status_t WiFiClass::begin() {
+  connectLater();
+  return linkStatus;
+}
+
+bool WiFiClass::reconnect() {
+  connectLater();
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap) {
+  if (linkStatus == WL_CONNECTED) simulateDisconnect(8);  // ASSOC_LEAVE
+  return true;
+}
+
+// The association completes on the event task a little later, as on the chip
+void WiFiClass::connectLater() {
+  if (linkStatus == WL_CONNECTED) return;
+  wifiMode = wifiMode == WIFI_MODE_NULL ? WIFI_STA : wifiMode;
+  std::thread([this]() {
+    delay(20);
+    WiFiEventInfo_t info;
+    memset(&info, 0, sizeof(info));
+    size_t ssidLength = min((size_t)ssid.length(), sizeof(info.wifi_sta_connected.ssid));
+    memcpy(info.wifi_sta_connected.ssid, ssid.c_str(), ssidLength);
+    info.wifi_sta_connected.ssid_len = ssidLength;
+    memcpy(info.wifi_sta_connected.bssid, nativeBssid, 6);
+    info.wifi_sta_connected.channel = 6;
+    info.wifi_sta_connected.authmode = WIFI_AUTH_WPA2_PSK;
+    dispatch(ARDUINO_EVENT_WIFI_STA_CONNECTED, info);
+    delay(10);
+    linkStatus = WL_CONNECTED;
+    dispatch(ARDUINO_EVENT_WIFI_STA_GOT_IP, info);
+  }).detach();
+}
+
+void WiFiClass::simulateDisconnect(uint8_t reason) {
+  linkStatus = WL_DISCONNECTED;
+  WiFiEventInfo_t info;
+  memset(&info, 0, sizeof(info));
+  info.wifi_sta_disconnected.reason = reason;
+  memcpy(info.wifi_sta_disconnected.bssid, nativeBssid, 6);
+  dispatch(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, info);
+}
+
+uint8_t* WiFiClass::BSSID() {
+  return (uint8_t*)nativeBssid;
+}
+
+String WiFiClass::BSSIDstr() {
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+           nativeBssid[0], nativeBssid[1], nativeBssid[2], nativeBssid[3], nativeBssid[4], nativeBssid[5]);
+  return String(buf);
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChan, uint8_t channel) {
+  scanStarted = millis();
+  scanState = WIFI_SCAN_RUNNING;
+  if (!async) {
+    delay(SCAN_DURATION_MS);
+    return scanComplete();
+  }
+  return WIFI_SCAN_RUNNING;
+}
+
+int16_t WiFiClass::scanComplete() {
+  if (scanState == WIFI_SCAN_RUNNING && millis() - scanStarted >= SCAN_DURATION_MS) {
+    scanState = SCAN_COUNT;
+  }
+  return scanState;
+}
+
+void WiFiClass::scanDelete() {
+  scanState = WIFI_SCAN_FAILED;
+}
+
+String WiFiClass::SSID(uint8_t index) {
+  return index < SCAN_COUNT ? String(scanEntries[index].ssid) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) {
+  return index < SCAN_COUNT ? scanEntries[index].rssi : 0;
+}
+
+int32_t WiFiClass::channel(uint8_t index) {
+  return index < SCAN_COUNT ? scanEntries[index].channel : 0;
+}
+
+uint8_t* WiFiClass::BSSID(uint8_t index) {
+  return index < SCAN_COUNT ? (uint8_t*)nativeBssid : nullptr;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index) {
+  return index < SCAN_COUNT ? scanEntries[index].auth : WIFI_AUTH_OPEN;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventCb cb, arduino_event_id_t event) {
+  return onEvent(WiFiEventFuncCb([cb](WiFiEvent_t e, WiFiEventInfo_t) { cb(e); }), event);
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventSysCb cb, arduino_event_id_t event) {
+  return onEvent(WiFiEventFuncCb(cb), event);
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cb, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> guard(eventLock);
+  EventHandler handler = {nextHandlerId++, event, cb};
+  handlers.push_back(handler);
+  return handler.id;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+  std::lock_guard<std::recursive_mutex> guard(eventLock);
+  for (size_t i = 0; i < handlers.size(); i++) {
+    if (handlers[i].id == id) {
+      handlers.erase(handlers.begin() + i);
+      return;
+    }
+  }
+}
+
+void WiFiClass::dispatch(arduino_event_id_t event, const WiFiEventInfo_t& info) {
+  std::lock_guard<std::recursive_mutex> guard(eventLock);
+  for (size_t i = 0; i < handlers.size(); i++) {
+    if (handlers[i].event == ARDUINO_EVENT_MAX || handlers[i].event == event) {
+      handlers[i].callback(event, info);
+    }
+  }
+}
@@ -0,0 +1,50 @@
+#include <WiFiManager.h>
+#include <ElegantOTA.h>
+
+ElegantOTAClass ElegantOTA;
+
+// ---------------------------------------------------------------- WiFiManager
+
+WiFiManagerParameter::WiFiManagerParameter(const char* id, const char* label, const char* defaultValue, int length)
+  : id(id), label(label), value(nullptr), length(0) {
+  setValue(defaultValue, length);
+}
+
+WiFiManagerParameter::~WiFiManagerParameter() {
+  delete[] value;
+}
+
+void WiFiManagerParameter::setValue(const char* defaultValue, int newLength) {
+  if (newLength < 0) return;
+  delete[] value;
+  length = newLength;
+  value = new char[length + 1];
+  memset(value, 0, length + 1);
+  if (defaultValue) strncpy(value, defaultValue, length);
+}
+
+// Saved credentials always work on loopback; wait for the association like
+// autoConnect() does on the chip
+bool WiFiManager::autoConnect(const char* apName, const char* apPassword) {
+  if (!saved) return startConfigPortal(apName, apPassword);
+  WiFi.mode(WIFI_STA);
+  WiFi.begin();
+  unsigned long started = millis();
+  while (WiFi.status() != WL_CONNECTED && millis() - started < 5000) {
+    delay(5);
+  }
+  return WiFi.status() == WL_CONNECTED;
+}
+
+bool WiFiManager::startConfigPortal(const char* apName, const char* apPassword) {
+  if (apCallback) apCallback(this);
+  return false;
+}
+
+// ---------------------------------------------------------------- ElegantOTA
+
+void ElegantOTAClass::begin(WebServer* server, const char* username, const char* password) {
+  server->on("/update", HTTP_GET, [server]() {
+    server->send(200, "text/html", "<html><body>ElegantOTA is not available in the native build</body></html>");
+  });
+}
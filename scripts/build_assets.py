@@ -0,0 +1,138 @@
+"""
+Dashboard asset pipeline for ESP32-S3 EasyConnect.
+
+Compresses every file in data/ with gzip, gives non-HTML assets
+content-hashed names (rewriting references in HTML files) and writes an
+assets.manifest describing URL path, strong ETag and cacheability. The
+output directory is what gets flashed as the LittleFS image.
+
+The same compressed assets are also emitted as const byte arrays in
+src/EasyConnect_assets.h, so the firmware serves the dashboard straight
+from flash even when the LittleFS image is missing.
+
+PlatformIO runs this as a pre: extra script. It can also be run by hand:
+    python scripts/build_assets.py <source dir> <output dir> [header]
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+MANIFEST = "assets.manifest"
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def hashed_name(name, digest):
+    root, ext = os.path.splitext(name)
+    return "%s.%s%s" % (root, digest[:8], ext)
+
+
+def content_type(name):
+    return CONTENT_TYPES.get(os.path.splitext(name)[1], "application/octet-stream")
+
+
+def write_header(path, assets):
+    lines = [
+        "// Generated by scripts/build_assets.py from data/ - do not edit",
+        "#pragma once",
+        "",
+    ]
+    for i, (url, etag, immutable, gz) in enumerate(assets):
+        lines.append("// %s" % url)
+        lines.append("static const uint8_t EMBEDDED_ASSET_%d[] PROGMEM = {" % i)
+        for off in range(0, len(gz), 16):
+            lines.append("  " + ", ".join("0x%02x" % b for b in gz[off:off + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+    lines.append("static const EmbeddedAsset EMBEDDED_ASSETS[] = {")
+    for i, (url, etag, immutable, gz) in enumerate(assets):
+        lines.append("  {\"%s\", \"\\\"%s\\\"\", \"%s\", %s, EMBEDDED_ASSET_%d, sizeof(EMBEDDED_ASSET_%d)},"
+                     % (url, etag, content_type(url), "true" if immutable else "false", i, i))
+    lines.append("};")
+    lines.append("")
+
+    text = "\n".join(lines)
+    # Leave the file untouched when nothing changed to avoid needless rebuilds
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def build(source_dir, output_dir, header_path=None):
+    if os.path.isdir(output_dir):
+        shutil.rmtree(output_dir)
+    os.makedirs(output_dir)
+
+    files = {}
+    for root, _, names in os.walk(source_dir):
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            rel = os.path.relpath(full, source_dir).replace(os.sep, "/")
+            with open(full, "rb") as f:
+                files[rel] = f.read()
+
+    # Hashed names for everything except HTML entry points
+    renames = {}
+    for rel, data in files.items():
+        if not rel.endswith(".html"):
+            renames[rel] = hashed_name(rel, content_hash(data))
+
+    manifest = []
+    embedded = []
+    for rel, data in sorted(files.items()):
+        if rel.endswith(".html"):
+            text = data.decode("utf-8")
+            for old, new in renames.items():
+                text = re.sub(r"(?<=[\"'/=])%s(?=[\"'?#])" % re.escape(old), new, text)
+            data = text.encode("utf-8")
+
+        url = "/" + renames.get(rel, rel)
+        immutable = rel in renames
+        out_path = os.path.join(output_dir, url.lstrip("/") + ".gz")
+        os.makedirs(os.path.dirname(out_path), exist_ok=True)
+
+        # mtime=0 keeps the output reproducible
+        gz = gzip.compress(data, compresslevel=9, mtime=0)
+        with open(out_path, "wb") as f:
+            f.write(gz)
+
+        manifest.append("%s \"%s\" %d" % (url, content_hash(data), 1 if immutable else 0))
+        embedded.append((url, content_hash(data), immutable, gz))
+        print("  %-28s %6d -> %6d bytes" % (url, len(data), len(gz)))
+
+    with open(os.path.join(output_dir, MANIFEST), "w") as f:
+        f.write("\n".join(manifest) + "\n")
+
+    if header_path:
+        write_header(header_path, embedded)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) not in (3, 4):
+        sys.exit("usage: build_assets.py <source dir> <output dir> [header]")
+    build(sys.argv[1], sys.argv[2], sys.argv[3] if len(sys.argv) == 4 else None)
+else:
+    Import("env")  # noqa: F821 (provided by PlatformIO/SCons)
+    print("Building dashboard assets")
+    build(os.path.join(env.subst("$PROJECT_DIR"), "data"),  # noqa: F821
+          env.subst("$PROJECT_DATA_DIR"),  # noqa: F821
+          os.path.join(env.subst("$PROJECT_DIR"), "src", "EasyConnect_assets.h"))  # noqa: F821
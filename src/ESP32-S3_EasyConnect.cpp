@@ -1,29 +1,91 @@
 #include "ESP32S3_EasyConnect.h"
 #include <stdarg.h>
+#include <lwip/sockets.h>
+
+// Dashboard compiled into the firmware by scripts/build_assets.py (optional)
+#if defined(__has_include)
+#if __has_include("EasyConnect_assets.h")
+#include "EasyConnect_assets.h"
+#define EASYCONNECT_EMBEDDED_ASSETS 1
+#endif
+#endif
 
 ESP32S3_EasyConnect EasyConnect;
 
+// Loop profiler hooks; they compile to nothing without EASYCONNECT_PROFILING
+#if EASYCONNECT_PROFILING
+#define PERF_BEGIN() uint32_t perfMark = ESP.getCycleCount(); \
+  loopProfile.period.record((perfMark - loopProfile.lastStartCycles) / perfCyclesPerMicro); \
+  loopProfile.lastStartCycles = perfMark
+#define PERF_STAGE(stage) perfMark = recordPerfStage(stage, perfMark)
+#else
+#define PERF_BEGIN()
+#define PERF_STAGE(stage)
+#endif
+
+// Survives deep sleep and software resets, so warm boots skip the NVS read
+RTC_DATA_ATTR static FastConnectCache rtcFastConnectCache;
+
+// The WiFiServer listener descriptor is private, so note which lwIP socket
+// begin() turned into a listener; this runs once per begin(), not per wait
+static bool isListeningSocket(int fd) {
+  int accepting = 0;
+  socklen_t length = sizeof(accepting);
+  return getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &accepting, &length) == 0 && accepting != 0;
+}
+
+template <typename Begin>
+static int listenSocketOpenedBy(Begin begin) {
+  bool listening[CONFIG_LWIP_MAX_SOCKETS];
+  for (int i = 0; i < CONFIG_LWIP_MAX_SOCKETS; i++) {
+    listening[i] = isListeningSocket(LWIP_SOCKET_OFFSET + i);
+  }
+  begin();
+  for (int i = 0; i < CONFIG_LWIP_MAX_SOCKETS; i++) {
+    if (!listening[i] && isListeningSocket(LWIP_SOCKET_OFFSET + i)) return LWIP_SOCKET_OFFSET + i;
+  }
+  return -1;
+}
+
 ESP32S3_EasyConnect::ESP32S3_EasyConnect() 
   : server(80),
     webSocket(81),
-    telnetServer(23) {
+    telnetServer(23),
+    portalDeviceName("name", "Device Name", "", (int)ConfigLimits::deviceName),
+    portalTheme("theme", "Theme (light/dark)", "", (int)ConfigLimits::theme),
+    portalTelnet("telnet", "Enable Telnet (0/1)", "", 2) {
   // Initialize with default values
-  config.deviceName = "ESP32-S3-Device";
-  config.theme = "dark";
-  config.enableOTA = true;
-  config.enableTelnet = true;
-  config.telnetPort = 23;
-  config.updateInterval = 5000;
-  config.customParam1 = "";
-  config.customParam2 = "";
-  config.customParam3 = 0;
-  config.customParam4 = 0.0;
+  resetConfig(config);
+  
+  memset(&statusStats, 0, sizeof(statusStats));
+  memset(&webSocketStats, 0, sizeof(webSocketStats));
+  memset(&configStoreStats, 0, sizeof(configStoreStats));
+  memset(&fastConnectCache, 0, sizeof(fastConnectCache));
+  memset(&bootStats, 0, sizeof(bootStats));
+  memset(&wifiLinkStats, 0, sizeof(wifiLinkStats));
   
-  // Initialize telnet clients
-  for (int i = 0; i < MAX_TELNET_CLIENTS; i++) {
-    telnetClients[i].connected = false;
-    telnetClients[i].lastActivity = 0;
+  // Built-in WebSocket topics
+  memset(webSocketSubs, 0, sizeof(webSocketSubs));
+  topicStatus = resolveTopic("status");
+  topicLog = resolveTopic("log");
+  topicScan = resolveTopic("scan");
+  topicBroadcast = resolveTopic("broadcast");
+  resetLoopStats();
+  registerBuiltinCommands();
+  
+  for (int i = 0; i < HTTP_ROUTE_COUNT; i++) metrics.httpRoutes[i].reset();
+  for (int i = 0; i < WS_COMMAND_COUNT; i++) metrics.webSocketCommands[i].reset();
+  for (int i = 0; i < 3; i++) metrics.commands[i].reset();
+  metrics.socketWake.reset();
+  for (int i = 0; i < TRANSPORT_COUNT; i++) {
+    metrics.bytesIn[i].store(0, std::memory_order_relaxed);
+    metrics.bytesOut[i].store(0, std::memory_order_relaxed);
   }
+  telemetryCounters.frames.store(0, std::memory_order_relaxed);
+  telemetryCounters.bytes.store(0, std::memory_order_relaxed);
+  telemetryCounters.encodeMicros.store(0, std::memory_order_relaxed);
+  telemetryCounters.jsonBytes.store(0, std::memory_order_relaxed);
+  telemetryCounters.jsonMicros.store(0, std::memory_order_relaxed);
 }
 
 bool ESP32S3_EasyConnect::begin(const char* deviceName) {
@@ -61,37 +123,42 @@ bool ESP32S3_EasyConnect::begin(const char* deviceName) {
   });
   
   // Custom parameters in WiFiManager
-  WiFiManagerParameter custom_deviceName("name", "Device Name", config.deviceName.c_str(), 40);
-  WiFiManagerParameter custom_theme("theme", "Theme (light/dark)", config.theme.c_str(), 10);
-  WiFiManagerParameter custom_telnet("telnet", "Enable Telnet (0/1)", config.enableTelnet ? "1" : "0", 2);
-  
-  wifiManager.addParameter(&custom_deviceName);
-  wifiManager.addParameter(&custom_theme);
-  wifiManager.addParameter(&custom_telnet);
+  portalDeviceName.setValue(config.deviceName.c_str(), (int)ConfigLimits::deviceName);
+  portalTheme.setValue(config.theme.c_str(), (int)ConfigLimits::theme);
+  portalTelnet.setValue(config.enableTelnet ? "1" : "0", 2);
   
-  // Attempt to connect to saved network or start configuration portal
-  bool res = wifiManager.autoConnect(config.deviceName.c_str());
+  wifiManager.addParameter(&portalDeviceName);
+  wifiManager.addParameter(&portalTheme);
+  wifiManager.addParameter(&portalTelnet);
   
-  if (!res) {
-    logln("❌ Failed to connect and hit timeout");
-    delay(3000);
-    ESP.restart();
+  if (fastConnectEnabled && startFastConnect()) {
+    // Association continues in the background; services come up right away
+    logln("⚡ Fast connect to " + String(fastConnectCache.ssid) + " on channel " + String(fastConnectCache.channel));
   } else {
-    logln("✅ WiFi Connected!");
-    log("IP Address: ");
-    logln(WiFi.localIP().toString());
-    isConnected = true;
+    // Attempt to connect to saved network or start configuration portal
+    flushLog();
+    bool res = wifiManager.autoConnect(config.deviceName.c_str());
     
-    if (onConnectedCallback != nullptr) {
-      onConnectedCallback();
+    if (!res) {
+      logln("❌ Failed to connect and hit timeout");
+      flushLog();
+      delay(3000);
+      ESP.restart();
+    } else {
+      logln("✅ WiFi Connected!");
+      log("IP Address: ");
+      logln(WiFi.localIP().toString());
+      isConnected = true;
+      recordWiFiUp();
+      
+      notifyEvent(EVENT_CONNECTED);
     }
+    
+    applyPortalParameters();
   }
   
-  // Update config with WiFiManager parameters
-  config.deviceName = custom_deviceName.getValue();
-  config.theme = custom_theme.getValue();
-  config.enableTelnet = (String(custom_telnet.getValue()) == "1");
-  saveConfig();
+  // React to link changes from here on instead of polling WiFi.status()
+  setupWiFiEvents();
   
   // Setup telnet server if enabled
   if (config.enableTelnet) {
@@ -108,369 +175,2563 @@ bool ESP32S3_EasyConnect::begin(const char* deviceName) {
     logln("✅ OTA Updates enabled at /update");
   }
   
-  server.begin();
+  httpListenFd = listenSocketOpenedBy([this]() { server.begin(); });
   logln("✅ HTTP server started on port 80");
   logln("✅ WebSocket server started on port 81");
   
   deviceUptime = millis();
+  flushLog();
+  resetLoopStats();
+#if EASYCONNECT_PROFILING
+  resetLoopProfile();
+#endif
+  armStatusTimer();
+  setupWakeSocket();
+  
+  // Hand HTTP, WebSocket, OTA and telnet over to a dedicated task
+  if (networkTaskRequested) {
+    configMutex = xSemaphoreCreateRecursiveMutex();
+    outboundQueue = xQueueCreate(NETWORK_QUEUE_LENGTH, sizeof(NetworkMessage));
+    eventQueue = xQueueCreate(NETWORK_QUEUE_LENGTH, sizeof(FrameworkEvent));
+    
+    if (configMutex == nullptr || outboundQueue == nullptr || eventQueue == nullptr ||
+        xTaskCreatePinnedToCore(networkTaskEntry, "EasyConnectNet", NETWORK_TASK_STACK, this, 1,
+                                &networkTask, networkTaskCore) != pdPASS) {
+      networkTask = nullptr;
+      logln("⚠️ Network task could not be started, running in loop()");
+    } else {
+      logf("✅ Network task running on core %d\n", (int)networkTaskCore);
+    }
+  }
+  
   return true;
 }
 
-void ESP32S3_EasyConnect::loop() {
-  server.handleClient();
-  webSocket.loop();
-  ElegantOTA.loop();
+void ESP32S3_EasyConnect::applyPortalParameters() {
+  // Update config with WiFiManager parameters, held to the same limits as /api/config
+  DeviceConfig portal;
+  resetConfig(portal);
+  portal.deviceName = portalDeviceName.getValue();
+  portal.theme = portalTheme.getValue();
+  portal.enableTelnet = (String(portalTelnet.getValue()) == "1");
+  clampConfig(portal);
+  if (portal.deviceName != config.deviceName || portal.theme != config.theme || portal.enableTelnet != config.enableTelnet) {
+    lockConfig();
+    config.deviceName = portal.deviceName;
+    config.theme = portal.theme;
+    config.enableTelnet = portal.enableTelnet;
+    unlockConfig();
+    markConfigDirty();
+  }
+}
+
+void ESP32S3_EasyConnect::enableFastConnect(bool reuseAddress) {
+  fastConnectEnabled = true;
+  fastConnectReuseAddress = reuseAddress;
+}
+
+bool ESP32S3_EasyConnect::loadFastConnectCache() {
+  if (rtcFastConnectCache.magic == FAST_CONNECT_MAGIC) {
+    memcpy(&fastConnectCache, &rtcFastConnectCache, sizeof(fastConnectCache));
+    return true;
+  }
   
-  // Update uptime
-  deviceUptime = millis();
+  // Cold boot: RTC memory is gone, fall back to the copy in NVS
+  Preferences prefs;
+  if (!prefs.begin(fastConnectNamespace, true)) {
+    return false;
+  }
+  bool valid = prefs.getBytesLength("fastConnect") == sizeof(fastConnectCache) &&
+               prefs.getBytes("fastConnect", &fastConnectCache, sizeof(fastConnectCache)) == sizeof(fastConnectCache) &&
+               fastConnectCache.magic == FAST_CONNECT_MAGIC;
+  prefs.end();
+  if (valid) {
+    memcpy(&rtcFastConnectCache, &fastConnectCache, sizeof(fastConnectCache));
+  }
+  return valid;
+}
+
+void ESP32S3_EasyConnect::saveFastConnectCache() {
+  if (!fastConnectEnabled) return;
   
-  // Handle Telnet connections and data
-  if (config.enableTelnet) {
-    handleTelnet();
+  FastConnectCache fresh;
+  memset(&fresh, 0, sizeof(fresh));
+  fresh.magic = FAST_CONNECT_MAGIC;
+  fresh.ip = WiFi.localIP();
+  fresh.gateway = WiFi.gatewayIP();
+  fresh.subnet = WiFi.subnetMask();
+  fresh.dns = WiFi.dnsIP();
+  fresh.channel = WiFi.channel();
+  uint8_t* bssid = WiFi.BSSID();
+  if (bssid != nullptr) {
+    memcpy(fresh.bssid, bssid, sizeof(fresh.bssid));
   }
+  strlcpy(fresh.ssid, WiFi.SSID().c_str(), sizeof(fresh.ssid));
   
-  // Handle WiFi reconnection
-  if (WiFi.status() != WL_CONNECTED) {
-    if (isConnected) {
-      isConnected = false;
-      logln("❌ WiFi disconnected");
-      if (onDisconnectedCallback != nullptr) {
-        onDisconnectedCallback();
-      }
-    }
-    
-    if (millis() - lastReconnectAttempt > 10000) {
-      logln("🔄 Attempting WiFi reconnection...");
-      WiFi.reconnect();
-      lastReconnectAttempt = millis();
+  // Same AP as last time: no flash write
+  if (memcmp(&fresh, &rtcFastConnectCache, sizeof(fresh)) == 0) return;
+  memcpy(&rtcFastConnectCache, &fresh, sizeof(fresh));
+  memcpy(&fastConnectCache, &fresh, sizeof(fresh));
+  
+  Preferences prefs;
+  if (prefs.begin(fastConnectNamespace, false)) {
+    prefs.putBytes("fastConnect", &fresh, sizeof(fresh));
+    prefs.end();
+  }
+}
+
+bool ESP32S3_EasyConnect::startFastConnect() {
+  if (!loadFastConnectCache()) {
+    return false;
+  }
+  
+  WiFi.mode(WIFI_STA);
+  // The password stays in the WiFi driver's own storage; only the SSID is cached
+  String password = WiFi.psk();
+  if (fastConnectReuseAddress && fastConnectCache.ip != 0) {
+    WiFi.config(IPAddress(fastConnectCache.ip), IPAddress(fastConnectCache.gateway),
+                IPAddress(fastConnectCache.subnet), IPAddress(fastConnectCache.dns));
+  }
+  // Don't pin the stored credentials to this BSSID/channel
+  WiFi.persistent(false);
+  WiFi.begin(fastConnectCache.ssid, password.c_str(), fastConnectCache.channel, fastConnectCache.bssid);
+  WiFi.persistent(true);
+  
+  bootWiFiState = BOOT_WIFI_FAST;
+  bootWiFiStarted = millis();
+  bootStats.fastConnect = true;
+  return true;
+}
+
+void ESP32S3_EasyConnect::pollBootWiFi() {
+  if (bootWiFiState == BOOT_WIFI_PORTAL) {
+    if (wifiManager.process()) {
+      applyPortalParameters();
+    } else if (!wifiManager.getConfigPortalActive()) {
+      logln("❌ Failed to connect and hit timeout");
+      flushLog();
+      delay(3000);
+      ESP.restart();
+    } else {
+      return;
     }
-  } else if (!isConnected) {
+  }
+  
+  if (WiFi.status() == WL_CONNECTED) {
+    bootWiFiState = BOOT_WIFI_DONE;
+    // Events raised while booting are already accounted for
+    wifiLinkEvents.store(0);
+    wifiLinkState = WIFI_LINK_UP;
+    logln("✅ WiFi Connected!");
+    log("IP Address: ");
+    logln(WiFi.localIP().toString());
     isConnected = true;
+    recordWiFiUp();
+    notifyEvent(EVENT_CONNECTED);
+    return;
+  }
+  
+  unsigned long elapsed = millis() - bootWiFiStarted;
+  if (bootWiFiState == BOOT_WIFI_FAST && elapsed > FAST_CONNECT_TIMEOUT) {
+    // AP moved or changed channel: let the driver scan for it
+    logln("⚠️ Fast connect failed, scanning for " + String(fastConnectCache.ssid));
+    bootStats.fastConnectFailed = true;
+    String password = WiFi.psk();
+    WiFi.disconnect();
+    if (fastConnectReuseAddress) {
+      WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    }
+    WiFi.begin(fastConnectCache.ssid, password.c_str());
+    bootWiFiState = BOOT_WIFI_FULL;
+    bootWiFiStarted = millis();
+  } else if (bootWiFiState == BOOT_WIFI_FULL && elapsed > FULL_CONNECT_TIMEOUT) {
+    logln("📱 Starting configuration portal");
+    wifiManager.setConfigPortalBlocking(false);
+    wifiManager.startConfigPortal(config.deviceName.c_str());
+    bootWiFiState = BOOT_WIFI_PORTAL;
+  }
+}
+
+void ESP32S3_EasyConnect::recordWiFiUp() {
+  if (bootStats.wifiConnectedMillis == 0) {
+    bootStats.wifiConnectedMillis = millis();
+  }
+  strlcpy(wifiSSID, WiFi.SSID().c_str(), sizeof(wifiSSID));
+  uint8_t* bssid = WiFi.BSSID();
+  if (bssid != nullptr) {
+    memcpy(wifiBSSID, bssid, sizeof(wifiBSSID));
+  }
+  saveFastConnectCache();
+}
+
+void ESP32S3_EasyConnect::setupWiFiEvents() {
+  // The framework owns the retry policy
+  WiFi.setAutoReconnect(false);
+  WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
+    // Runs on the WiFi event task: only record, serviceWiFiLink() acts on it
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+      wifiLinkEvents.fetch_or(WIFI_LINK_EVENT_UP);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+      wifiDisconnectReason.store(info.wifi_sta_disconnected.reason);
+      wifiLinkEvents.fetch_or(WIFI_LINK_EVENT_DOWN);
+    }
+    wakeNetwork();
+  });
+}
+
+void ESP32S3_EasyConnect::serviceWiFiLink() {
+  uint8_t events = wifiLinkEvents.exchange(0);
+  if (events == (WIFI_LINK_EVENT_UP | WIFI_LINK_EVENT_DOWN)) {
+    // Both since the last iteration: the current status says which came last
+    events = (WiFi.status() == WL_CONNECTED) ? WIFI_LINK_EVENT_UP : WIFI_LINK_EVENT_DOWN;
+  }
+  if (events & WIFI_LINK_EVENT_DOWN) {
+    onWiFiLinkDown(wifiDisconnectReason.load());
+  }
+  if (events & WIFI_LINK_EVENT_UP) {
+    onWiFiLinkUp();
+  }
+  
+  switch (wifiLinkState) {
+    case WIFI_LINK_UP:
+    case WIFI_LINK_BACKOFF:
+    case WIFI_LINK_RECONNECTING:
+      // Backoff delay and attempt timeout run on wifiTimer
+      break;
+      
+    case WIFI_LINK_SCANNING:
+      // Shares the /api/scan job; results reach the dashboard as well
+      if (!scanInProgress && !roamToStrongestAP()) {
+        logln("📡 " + String(wifiSSID) + " not found in scan");
+        scheduleWiFiAttempt();
+      }
+      break;
+      
+    case WIFI_LINK_PORTAL:
+      if (wifiManager.process()) {
+        applyPortalParameters();
+      } else if (!wifiManager.getConfigPortalActive()) {
+        // Portal timed out: start the cycle again rather than restarting
+        wifiAttempts = 0;
+        wifiAuthFailures = 0;
+        scheduleWiFiAttempt();
+      }
+      break;
+  }
+}
+
+void ESP32S3_EasyConnect::onWiFiLinkDown(uint8_t reason) {
+  wifiLinkStats.lastReason = reason;
+  wifiAuthFailures = isAuthFailure(reason) ? wifiAuthFailures + 1 : 0;
+  
+  if (isConnected) {
+    isConnected = false;
+    wifiDownSince = millis();
+    wifiAttempts = 0;
+    wifiLinkStats.disconnects++;
+    logln("❌ WiFi disconnected: " + describeWiFiReason(reason));
+    notifyEvent(EVENT_DISCONNECTED);
+    scheduleWiFiAttempt();
+  } else if (wifiLinkState == WIFI_LINK_RECONNECTING) {
+    logln("⚠️ WiFi attempt " + String(wifiAttempts) + " failed: " + describeWiFiReason(reason));
+    scheduleWiFiAttempt();
+  }
+  // Other states: our own disconnect() for a scan, or already waiting
+}
+
+void ESP32S3_EasyConnect::onWiFiLinkUp() {
+  wifiLinkState = WIFI_LINK_UP;
+  timers.cancel(wifiTimer);
+  wifiAttempts = 0;
+  wifiAuthFailures = 0;
+  if (isConnected) return;
+  
+  isConnected = true;
+  if (wifiDownSince != 0) {
+    unsigned long outage = millis() - wifiDownSince;
+    wifiLinkStats.lastOutageMillis = outage;
+    wifiLinkStats.totalOutageMillis += outage;
+    wifiLinkStats.longestOutageMillis = max(wifiLinkStats.longestOutageMillis, outage);
+    wifiDownSince = 0;
+    logln("✅ WiFi reconnected after " + String(outage) + " ms");
+  } else {
     logln("✅ WiFi reconnected");
-    if (onConnectedCallback != nullptr) {
-      onConnectedCallback();
+  }
+  recordWiFiUp();
+  notifyEvent(EVENT_CONNECTED);
+}
+
+void ESP32S3_EasyConnect::scheduleWiFiAttempt() {
+  // Equal jitter: half the exponential delay fixed, half random, so a fleet
+  // that lost the same AP doesn't retry in lockstep
+  uint32_t shift = min(wifiAttempts, (uint32_t)6);
+  unsigned long delayMs = min(WIFI_BACKOFF_BASE << shift, (unsigned long)WIFI_BACKOFF_MAX);
+  delayMs = delayMs / 2 + random(delayMs / 2 + 1);
+  
+  wifiLinkState = WIFI_LINK_BACKOFF;
+  armWiFiTimer(delayMs);
+}
+
+void ESP32S3_EasyConnect::armWiFiTimer(uint32_t delayMs) {
+  timers.cancel(wifiTimer);
+  wifiTimer = timers.schedule(delayMs, 0, [](void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    if (ec->wifiLinkState == WIFI_LINK_BACKOFF) {
+      ec->startWiFiAttempt();
+    } else if (ec->wifiLinkState == WIFI_LINK_RECONNECTING) {
+      // Attempt timed out without a disconnect event
+      ec->scheduleWiFiAttempt();
     }
+  }, this);
+}
+
+void ESP32S3_EasyConnect::startWiFiAttempt() {
+  wifiAttempts++;
+  wifiLinkStats.reconnectAttempts++;
+  
+  // Wrong credentials won't fix themselves: go to the portal early
+  if (wifiAttempts > WIFI_PORTAL_AFTER || wifiAuthFailures >= WIFI_AUTH_FAILURE_LIMIT) {
+    logln("📱 WiFi not recovering, starting configuration portal");
+    wifiLinkStats.portalStarts++;
+    wifiManager.setConfigPortalBlocking(false);
+    wifiManager.startConfigPortal(config.deviceName.c_str());
+    wifiLinkState = WIFI_LINK_PORTAL;
+    return;
   }
   
-  // Send periodic updates via WebSocket
-  if (millis() - lastUpdate > config.updateInterval) {
-    sendDeviceStatus();
-    lastUpdate = millis();
+  if (wifiAttempts > WIFI_RESCAN_AFTER) {
+    logln("📡 Scanning for a stronger access point (attempt " + String(wifiAttempts) + ")");
+    WiFi.disconnect();
+    if (!scanInProgress) {
+      startScan();
+    }
+    if (!scanInProgress) {
+      scheduleWiFiAttempt();
+      return;
+    }
+    wifiRoamScanJob = scanJobId;
+    wifiLinkState = WIFI_LINK_SCANNING;
+    return;
   }
+  
+  logln("🔄 Attempting WiFi reconnection (attempt " + String(wifiAttempts) + ")");
+  WiFi.reconnect();
+  wifiLinkState = WIFI_LINK_RECONNECTING;
+  armWiFiTimer(WIFI_ATTEMPT_TIMEOUT);
 }
 
-void ESP32S3_EasyConnect::setupTelnet() {
-  telnetServer.begin();
-  telnetServer.setNoDelay(true);
-  telnetEnabled = true;
+bool ESP32S3_EasyConnect::roamToStrongestAP() {
+  if (!scanResultsValid || scanJobId != wifiRoamScanJob) {
+    return false;
+  }
   
-  log("✅ Telnet server started on port ");
-  logln(String(config.telnetPort));
-  logln("💡 Connect using: telnet " + WiFi.localIP().toString());
+  int best = -1;
+  for (int i = 0; i < scanResultCount; i++) {
+    if (strcmp(scanResults[i].ssid, wifiSSID) == 0 &&
+        (best < 0 || scanResults[i].rssi > scanResults[best].rssi)) {
+      best = i;
+    }
+  }
+  if (best < 0) {
+    return false;
+  }
+  
+  const ScanResult& ap = scanResults[best];
+  if (memcmp(ap.bssid, wifiBSSID, sizeof(wifiBSSID)) != 0) {
+    wifiLinkStats.roams++;
+  }
+  logln("📶 Joining " + String(ap.ssid) + " on channel " + String(ap.channel) + " (" + String(ap.rssi) + " dBm)");
+  String password = WiFi.psk();
+  WiFi.persistent(false);
+  WiFi.begin(wifiSSID, password.c_str(), ap.channel, ap.bssid);
+  WiFi.persistent(true);
+  wifiLinkState = WIFI_LINK_RECONNECTING;
+  armWiFiTimer(WIFI_ATTEMPT_TIMEOUT);
+  return true;
 }
 
-void ESP32S3_EasyConnect::handleTelnet() {
-  // Check for new connections
-  if (telnetServer.hasClient()) {
-    bool connectionAccepted = false;
-    
-    for (int i = 0; i < MAX_TELNET_CLIENTS; i++) {
-      if (!telnetClients[i].connected) {
-        if (telnetClients[i].client) {
-          telnetClients[i].client.stop();
-        }
-        
-        telnetClients[i].client = telnetServer.available();
-        telnetClients[i].connected = true;
-        telnetClients[i].lastActivity = millis();
-        
-        // Send welcome message
-        String welcome = "\r\n";
-        welcome += "┌────────────────────────────────────────┐\r\n";
-        welcome += "│       ESP32-S3 EasyConnect Telnet     │\r\n";
-        welcome += "│              Framework v1.2.0         │\r\n";
-        welcome += "└────────────────────────────────────────┘\r\n";
-        welcome += "Device: " + config.deviceName + "\r\n";
-        welcome += "IP: " + WiFi.localIP().toString() + "\r\n";
-        welcome += "Free Heap: " + String(ESP.getFreeHeap()) + " bytes\r\n";
-        welcome += "Uptime: " + String(deviceUptime / 1000) + "s\r\n";
-        welcome += "Connected clients: " + String(getTelnetClientCount()) + "/" + String(MAX_TELNET_CLIENTS) + "\r\n";
-        welcome += "Type 'help' for available commands\r\n";
-        welcome += "----------------------------------------\r\n";
-        welcome += "> ";
-        
-        telnetClients[i].client.print(welcome);
-        connectionAccepted = true;
-        
-        log("🔌 Telnet client connected from: ");
-        logln(telnetClients[i].client.remoteIP().toString());
-        break;
+bool ESP32S3_EasyConnect::isAuthFailure(uint8_t reason) {
+  return reason == WIFI_REASON_AUTH_FAIL || reason == WIFI_REASON_AUTH_EXPIRE ||
+         reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_HANDSHAKE_TIMEOUT;
+}
+
+String ESP32S3_EasyConnect::describeWiFiReason(uint8_t reason) {
+  if (isAuthFailure(reason)) return "authentication failed";
+  if (reason == WIFI_REASON_NO_AP_FOUND || reason == WIFI_REASON_BEACON_TIMEOUT) return "access point out of range";
+  if (reason == WIFI_REASON_ASSOC_FAIL || reason == WIFI_REASON_CONNECTION_FAIL) return "association failed";
+  return "reason " + String(reason);
+}
+
+WiFiLinkStats ESP32S3_EasyConnect::getWiFiLinkStats() {
+  return wifiLinkStats;
+}
+
+BootStats ESP32S3_EasyConnect::getBootStats() {
+  return bootStats;
+}
+
+void ESP32S3_EasyConnect::enableNetworkTask(BaseType_t core) {
+  networkTaskRequested = true;
+  networkTaskCore = core;
+}
+
+void ESP32S3_EasyConnect::networkTaskEntry(void* arg) {
+  ESP32S3_EasyConnect* self = static_cast<ESP32S3_EasyConnect*>(arg);
+  for (;;) {
+    self->serviceNetwork();
+    if (!self->waitForActivity(IDLE_MAX_WAIT)) {
+      vTaskDelay(1);  // Let the idle task on this core run
+    }
+  }
+}
+
+void ESP32S3_EasyConnect::loop() {
+  if (networkTask != nullptr) {
+    // Network work runs on its own task; deliver callbacks on the caller's task
+    FrameworkEvent event;
+    while (xQueueReceive(eventQueue, &event, 0) == pdTRUE) {
+      dispatchEvent(event);
+    }
+  } else {
+    serviceNetwork();
+  }
+  appTimers.run(millis());
+}
+
+// Periodic status push; re-armed on every tick so updateInterval changes apply
+void ESP32S3_EasyConnect::armStatusTimer() {
+  statusTimer = timers.schedule(config.updateInterval, 0, [](void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    ec->sendDeviceStatus();
+    ec->armStatusTimer();
+  }, this);
+}
+
+TimerWheel::TimerWheel() {
+  memset(heads, -1, sizeof(heads));
+  memset(occupied, 0, sizeof(occupied));
+  for (int i = 0; i < MAX_TIMERS; i++) {
+    timers[i].used = false;
+    timers[i].generation = 1;
+    timers[i].next = (i + 1 < MAX_TIMERS) ? i + 1 : -1;
+  }
+  freeHead = 0;
+}
+
+TimerId TimerWheel::schedule(uint32_t delayMs, uint32_t periodMs, TimerCallback callback, void* arg) {
+  if (callback == nullptr || freeHead < 0) return 0;
+  
+  uint32_t now = millis();
+  if (!started || count == 0) {
+    // Nothing pending, so the wheel may have stopped advancing
+    currentTick = now;
+    started = true;
+  }
+  
+  int index = freeHead;
+  Timer& t = timers[index];
+  freeHead = t.next;
+  t.used = true;
+  t.expires = now + delayMs;
+  if ((int32_t)(t.expires - currentTick) <= 0) {
+    // Due now: fire on the next tick, not in the pass that scheduled it
+    t.expires = currentTick + 1;
+  }
+  t.period = periodMs;
+  t.callback = callback;
+  t.arg = arg;
+  link(index);
+  count++;
+  return ((TimerId)t.generation << 8) | index;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+  int index = id & 0xFF;
+  if (id == 0 || index >= MAX_TIMERS) return false;
+  Timer& t = timers[index];
+  if (!t.used || t.generation != (id >> 8)) return false;
+  unlink(index);
+  release(index);
+  return true;
+}
+
+void TimerWheel::link(int index) {
+  Timer& t = timers[index];
+  uint32_t expires = t.expires;
+  int32_t delta = (int32_t)(expires - currentTick);
+  int level = 0;
+  if (delta < 0) {
+    expires = currentTick;
+  } else if ((uint32_t)delta >= (1UL << (SLOT_BITS * LEVELS))) {
+    // Beyond the wheel: park in the top level, re-queued when it comes round
+    expires = currentTick + (1UL << (SLOT_BITS * LEVELS)) - 1;
+    level = LEVELS - 1;
+  } else {
+    while (level < LEVELS - 1 && (uint32_t)delta >= (1UL << (SLOT_BITS * (level + 1)))) level++;
+  }
+  
+  int slot = (expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+  t.level = level;
+  t.slot = slot;
+  t.prev = -1;
+  t.next = heads[level][slot];
+  if (t.next >= 0) timers[t.next].prev = index;
+  heads[level][slot] = index;
+  occupied[level] |= 1ULL << slot;
+}
+
+void TimerWheel::unlink(int index) {
+  Timer& t = timers[index];
+  if (t.prev >= 0) {
+    timers[t.prev].next = t.next;
+  } else {
+    heads[t.level][t.slot] = t.next;
+  }
+  if (t.next >= 0) timers[t.next].prev = t.prev;
+  if (heads[t.level][t.slot] < 0) {
+    occupied[t.level] &= ~(1ULL << t.slot);
+  }
+}
+
+void TimerWheel::release(int index) {
+  Timer& t = timers[index];
+  t.used = false;
+  t.generation = (t.generation == 0xFFFF) ? 1 : t.generation + 1;
+  t.next = freeHead;
+  freeHead = index;
+  count--;
+}
+
+// Move the timers of the current slot at this level down the hierarchy
+void TimerWheel::cascade(int level) {
+  int slot = (currentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+  while (heads[level][slot] >= 0) {
+    int index = heads[level][slot];
+    unlink(index);
+    link(index);
+  }
+}
+
+void TimerWheel::run(uint32_t nowMs) {
+  while (count > 0 && (int32_t)(nowMs - currentTick) >= 0) {
+    int slot = currentTick & (SLOTS - 1);
+    if (slot == 0) {
+      for (int level = 1; level < LEVELS; level++) {
+        cascade(level);
+        if (((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)) != 0) break;
       }
     }
     
-    if (!connectionAccepted) {
-      // No free slots, reject connection
-      WiFiClient client = telnetServer.available();
-      client.print("❌ Maximum telnet clients reached (" + String(MAX_TELNET_CLIENTS) + "). Try again later.\r\n");
-      client.stop();
-      logln("⚠️ Telnet connection rejected - maximum clients reached");
-    }
-  }
-  
-  // Handle data from connected clients
-  for (int i = 0; i < MAX_TELNET_CLIENTS; i++) {
-    if (telnetClients[i].connected && telnetClients[i].client.connected()) {
-      // Check for incoming data
-      while (telnetClients[i].client.available()) {
-        String command = telnetClients[i].client.readStringUntil('\n');
-        command.trim();
-        
-        if (command.length() > 0) {
-          telnetClients[i].lastActivity = millis();
-          
-          log("📨 Telnet command from ");
-          log(telnetClients[i].client.remoteIP().toString());
-          log(": ");
-          logln(command);
-          
-          // Handle built-in commands
-          if (command == "help" || command == "?") {
-            String help = "Available commands:\r\n";
-            help += "  help, ?       - Show this help\r\n";
-            help += "  status        - Show device status\r\n";
-            help += "  restart       - Restart device\r\n";
-            help += "  factoryreset  - Factory reset\r\n";
-            help += "  clients       - Show connected clients\r\n";
-            help += "  wifi          - Show WiFi info\r\n";
-            help += "  memory        - Show memory usage\r\n";
-            help += "  config        - Show current configuration\r\n";
-            help += "  clear, cls    - Clear screen\r\n";
-            help += "  disconnect    - Disconnect this session\r\n";
-            help += "Custom commands can be added via callback\r\n";
-            help += "> ";
-            telnetClients[i].client.print(help);
-            
-          } else if (command == "status") {
-            String status = "Device Status:\r\n";
-            status += "  Name: " + config.deviceName + "\r\n";
-            status += "  Uptime: " + String(deviceUptime / 1000) + "s\r\n";
-            status += "  Free Heap: " + String(ESP.getFreeHeap()) + " bytes\r\n";
-            status += "  WiFi: " + String(WiFi.SSID()) + " (" + String(WiFi.RSSI()) + " dBm)\r\n";
-            status += "  IP: " + WiFi.localIP().toString() + "\r\n";
-            status += "  Telnet clients: " + String(getTelnetClientCount()) + "/" + String(MAX_TELNET_CLIENTS) + "\r\n";
-            status += "> ";
-            telnetClients[i].client.print(status);
-            
-          } else if (command == "restart") {
-            telnetClients[i].client.print("🔄 Restarting device...\r\n");
-            delay(1000);
-            restartDevice();
-            
-          } else if (command == "factoryreset") {
-            telnetClients[i].client.print("🗑️ Factory reset...\r\n");
-            delay(1000);
-            factoryReset();
-            
-          } else if (command == "clients") {
-            String clients = "Connected Telnet Clients:\r\n";
-            for (int j = 0; j < MAX_TELNET_CLIENTS; j++) {
-              if (telnetClients[j].connected && telnetClients[j].client.connected()) {
-                clients += "  " + String(j+1) + ". " + telnetClients[j].client.remoteIP().toString() + 
-                          " (active " + String((millis() - telnetClients[j].lastActivity) / 1000) + "s ago)\r\n";
-              }
-            }
-            clients += "> ";
-            telnetClients[i].client.print(clients);
-            
-          } else if (command == "wifi") {
-            String wifiInfo = "WiFi Information:\r\n";
-            wifiInfo += "  SSID: " + String(WiFi.SSID()) + "\r\n";
-            wifiInfo += "  IP: " + WiFi.localIP().toString() + "\r\n";
-            wifiInfo += "  MAC: " + String(WiFi.macAddress()) + "\r\n";
-            wifiInfo += "  RSSI: " + String(WiFi.RSSI()) + " dBm\r\n";
-            wifiInfo += "  Channel: " + String(WiFi.channel()) + "\r\n";
-            wifiInfo += "> ";
-            telnetClients[i].client.print(wifiInfo);
-            
-          } else if (command == "memory") {
-            String memInfo = "Memory Information:\r\n";
-            memInfo += "  Free Heap: " + String(ESP.getFreeHeap()) + " bytes\r\n";
-            memInfo += "  Min Free Heap: " + String(ESP.getMinFreeHeap()) + " bytes\r\n";
-            memInfo += "  Max Alloc Heap: " + String(ESP.getMaxAllocHeap()) + " bytes\r\n";
-            memInfo += "  PSRAM Size: " + String(ESP.getPsramSize()) + " bytes\r\n";
-            memInfo += "  Free PSRAM: " + String(ESP.getFreePsram()) + " bytes\r\n";
-            memInfo += "> ";
-            telnetClients[i].client.print(memInfo);
-            
-          } else if (command == "config") {
-            String configInfo = "Current Configuration:\r\n";
-            configInfo += "  Device Name: " + config.deviceName + "\r\n";
-            configInfo += "  Theme: " + config.theme + "\r\n";
-            configInfo += "  OTA Enabled: " + String(config.enableOTA ? "Yes" : "No") + "\r\n";
-            configInfo += "  Telnet Enabled: " + String(config.enableTelnet ? "Yes" : "No") + "\r\n";
-            configInfo += "  Update Interval: " + String(config.updateInterval) + "ms\r\n";
-            configInfo += "  Custom1: " + config.customParam1 + "\r\n";
-            configInfo += "  Custom2: " + config.customParam2 + "\r\n";
-            configInfo += "  Custom3: " + String(config.customParam3) + "\r\n";
-            configInfo += "  Custom4: " + String(config.customParam4) + "\r\n";
-            configInfo += "> ";
-            telnetClients[i].client.print(configInfo);
-            
-          } else if (command == "clear" || command == "cls") {
-            // Clear screen (ANSI escape codes)
-            telnetClients[i].client.print("\033[2J\033[H"); // Clear screen and move to home
-            telnetClients[i].client.print("> ");
-            
-          } else if (command == "disconnect") {
-            telnetClients[i].client.print("👋 Disconnecting...\r\n");
-            telnetClients[i].client.stop();
-            telnetClients[i].connected = false;
-            
-          } else {
-            // Pass command to custom callback if set
-            if (telnetCommandCallback != nullptr) {
-              telnetCommandCallback(command, telnetClients[i].client);
-            } else {
-              telnetClients[i].client.print("❌ Unknown command. Type 'help' for available commands.\r\n> ");
-            }
-          }
-        }
+    while (heads[0][slot] >= 0) {
+      int index = heads[0][slot];
+      Timer& t = timers[index];
+      unlink(index);
+      if ((int32_t)(t.expires - currentTick) > 0) {
+        // Parked long timer, not due yet
+        link(index);
+        continue;
       }
       
-      // Check for client timeout (10 minutes)
-      if (millis() - telnetClients[i].lastActivity > 600000) {
-        log("⏰ Telnet client timeout: ");
-        logln(telnetClients[i].client.remoteIP().toString());
-        telnetClients[i].client.print("⏰ Connection timeout. Goodbye!\r\n");
-        telnetClients[i].client.stop();
-        telnetClients[i].connected = false;
-      }
-    } else {
-      // Client disconnected
-      if (telnetClients[i].connected) {
-        log("🔌 Telnet client disconnected: ");
-        logln(telnetClients[i].client.remoteIP().toString());
-        telnetClients[i].connected = false;
+      TimerCallback callback = t.callback;
+      void* arg = t.arg;
+      if (t.period > 0) {
+        t.expires += t.period;
+        if ((int32_t)(t.expires - currentTick) <= 0) {
+          // Fell behind by more than a period: skip the missed runs
+          t.expires = currentTick + t.period;
+        }
+        link(index);
+      } else {
+        release(index);
       }
+      callback(arg);
     }
+    currentTick++;
+  }
+  if (count == 0) {
+    currentTick = nowMs;
   }
 }
 
-void ESP32S3_EasyConnect::broadcastTelnet(String message) {
-  if (!config.enableTelnet) return;
+uint32_t TimerWheel::nextDeadline(uint32_t nowMs) const {
+  if (count == 0) return NO_DEADLINE;
   
-  for (int i = 0; i < MAX_TELNET_CLIENTS; i++) {
-    if (telnetClients[i].connected && telnetClients[i].client.connected()) {
-      telnetClients[i].client.print(message);
-    }
+  uint32_t nearest = NO_DEADLINE;  // Ticks after currentTick
+  for (int level = 0; level < LEVELS; level++) {
+    if (occupied[level] == 0) continue;
+    
+    // Level 0 slots are due at their tick, higher slots when they cascade.
+    // A higher level's current slot was cascaded already, unless the
+    // wheel sits exactly on its boundary.
+    int shift = SLOT_BITS * level;
+    uint32_t index = (currentTick >> shift) & (SLOTS - 1);
+    bool currentPending = level == 0 || (currentTick & ((1UL << shift) - 1)) == 0;
+    uint32_t first = currentPending ? index : index + 1;
+    int rotate = first & (SLOTS - 1);
+    uint64_t bits = rotate ? (occupied[level] >> rotate) | (occupied[level] << (SLOTS - rotate)) : occupied[level];
+    uint32_t slotsAhead = (first - index) + __builtin_ctzll(bits);
+    uint32_t distance = (((currentTick >> shift) + slotsAhead) << shift) - currentTick;
+    nearest = min(nearest, distance);
   }
+  
+  int32_t remaining = (int32_t)(currentTick + nearest - nowMs);
+  return remaining > 0 ? remaining : 0;
 }
 
-void ESP32S3_EasyConnect::sendToTelnet(String message) {
-  if (!config.enableTelnet) return;
-  broadcastTelnet(message);
+static void callPlainTimer(void* arg) {
+  reinterpret_cast<void (*)()>(arg)();
 }
 
-// Enhanced logging system
-void ESP32S3_EasyConnect::log(String message) {
-  Serial.print(message);
-  sendToTelnet(message);
+TimerId ESP32S3_EasyConnect::every(uint32_t intervalMs, void (*callback)()) {
+  if (callback == nullptr) return 0;
+  return every(intervalMs, callPlainTimer, reinterpret_cast<void*>(callback));
 }
 
-void ESP32S3_EasyConnect::logln(String message) {
-  Serial.println(message);
-  sendToTelnet(message + "\r\n");
+TimerId ESP32S3_EasyConnect::after(uint32_t delayMs, void (*callback)()) {
+  if (callback == nullptr) return 0;
+  return after(delayMs, callPlainTimer, reinterpret_cast<void*>(callback));
 }
 
-void ESP32S3_EasyConnect::logf(const char* format, ...) {
-  char buffer[256];
-  va_list args;
-  va_start(args, format);
-  vsnprintf(buffer, sizeof(buffer), format, args);
-  va_end(args);
+TimerId ESP32S3_EasyConnect::every(uint32_t intervalMs, TimerCallback callback, void* arg) {
+  uint32_t period = max(intervalMs, (uint32_t)1);
+  return appTimers.schedule(period, period, callback, arg);
+}
+
+TimerId ESP32S3_EasyConnect::after(uint32_t delayMs, TimerCallback callback, void* arg) {
+  return appTimers.schedule(delayMs, 0, callback, arg);
+}
+
+bool ESP32S3_EasyConnect::cancelTimer(TimerId id) {
+  return appTimers.cancel(id);
+}
+
+uint32_t ESP32S3_EasyConnect::getNextDeadline() {
+  uint32_t now = millis();
+  uint32_t next = appTimers.nextDeadline(now);
+  if (networkTask == nullptr) {
+    // Framework timers run from loop() as well
+    next = min(next, timers.nextDeadline(now));
+  }
+  return next;
+}
+
+void ESP32S3_EasyConnect::waitForEvents(uint32_t maxWaitMs) {
+  uint32_t waitMs = min(maxWaitMs, appTimers.nextDeadline(millis()));
+  if (networkTask != nullptr) {
+    // Sockets belong to the network task; sleep until it posts an event
+    FrameworkEvent event;
+    xQueuePeek(eventQueue, &event, pdMS_TO_TICKS(waitMs));
+    return;
+  }
+  waitForActivity(waitMs);
+}
+
+IdleStats ESP32S3_EasyConnect::getIdleStats() {
+  return idleStats;
+}
+
+// Loopback UDP socket: other tasks send a byte to it to end a select() early
+void ESP32S3_EasyConnect::setupWakeSocket() {
+  wakeSocket = socket(AF_INET, SOCK_DGRAM, 0);
+  if (wakeSocket < 0) {
+    logln("⚠️ No wake socket, idle waits end on timers only");
+    return;
+  }
   
-  Serial.print(buffer);
-  sendToTelnet(buffer);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t length = sizeof(addr);
+  if (bind(wakeSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+      getsockname(wakeSocket, (struct sockaddr*)&addr, &length) < 0) {
+    logln("⚠️ No wake socket, idle waits end on timers only");
+    close(wakeSocket);
+    wakeSocket = -1;
+    return;
+  }
+  wakePort = ntohs(addr.sin_port);
 }
 
-bool ESP32S3_EasyConnect::loadConfig() {
-  File file = LittleFS.open(configFile, "r");
-  if (!file) {
-    logln("❌ Failed to open config file for reading");
+// Any task except ISRs; costs nothing unless the network side is blocked
+void ESP32S3_EasyConnect::wakeNetwork() {
+  if (wakeSocket < 0 || !idleWaiting.load()) return;
+  
+  struct sockaddr_in to;
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  to.sin_port = htons(wakePort);
+  uint8_t token = 1;
+  sendto(wakeSocket, &token, 1, MSG_DONTWAIT, (struct sockaddr*)&to, sizeof(to));
+}
+
+// Block until a socket is ready, another task pokes the wake socket or
+// maxWaitMs passes; returns false when there was a reason not to block
+bool ESP32S3_EasyConnect::waitForActivity(uint32_t maxWaitMs) {
+  uint32_t waitMs = min(maxWaitMs, timers.nextDeadline(millis()));
+  if (bootWiFiState != BOOT_WIFI_DONE || scanInProgress ||
+      wifiLinkState == WIFI_LINK_SCANNING || wifiLinkState == WIFI_LINK_PORTAL) {
+    // Connection progress, scan results and the portal are polled, not signalled
+    waitMs = min(waitMs, (uint32_t)IDLE_POLL_INTERVAL);
+  }
+  if (waitMs == 0 || telnetBacklog) return false;
+  
+  // WiFiClient buffers received bytes where select() cannot see them, and
+  // the libraries take one HTTP request or WebSocket frame per pass
+  if (server.clientHasData()) return false;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (webSocket.clientHasData(i)) return false;
+  }
+  
+  // Only the sockets the framework owns: HTTP, WebSocket and telnet
+  // listeners and clients, plus the wake socket
+  fd_set readable;
+  fd_set writable;
+  FD_ZERO(&readable);
+  FD_ZERO(&writable);
+  int maxFd = -1;
+  auto watch = [&](int fd, fd_set* set) {
+    if (fd < 0) return;
+    FD_SET(fd, set);
+    if (fd > maxFd) maxFd = fd;
+  };
+  watch(wakeSocket, &readable);
+  watch(httpListenFd, &readable);
+  watch(server.clientFd(), &readable);
+  watch(webSocketListenFd, &readable);
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    watch(webSocket.clientFd(i), &readable);
+  }
+  if (telnetEnabled) watch(telnetListenFd, &readable);
+  for (int i = 0; i < telnetSlots; i++) {
+    TelnetClient& tc = telnetClients[i];
+    int fd = tc.connected ? tc.client.fd() : -1;
+    watch(fd, &readable);
+    if (tc.output.count > 0 || tc.output.pendingNotice > 0) watch(fd, &writable);
+  }
+  if (maxFd < 0) return false;
+  if (httpListenFd < 0 || webSocketListenFd < 0 || (telnetEnabled && telnetListenFd < 0)) {
+    // A listener we could not identify is polled rather than missed
+    waitMs = min(waitMs, (uint32_t)IDLE_POLL_INTERVAL);
+  }
+  
+  // Announce the wait before the last look at cross-task work: a producer
+  // either sees the flag and pokes the wake socket, or its work is seen here
+  idleWaiting.store(true);
+  lockConfig();
+  bool pending = pendingConfigSet;
+  unlockConfig();
+  pending = pending || wifiLinkEvents.load() != 0 || logRing.peek() != nullptr ||
+            (outboundQueue != nullptr && uxQueueMessagesWaiting(outboundQueue) > 0);
+  if (pending) {
+    idleWaiting.store(false);
     return false;
   }
   
-  size_t size = file.size();
-  std::unique_ptr<char[]> buf(new char[size]);
-  file.readBytes(buf.get(), size);
-  file.close();
+  struct timeval timeout;
+  timeout.tv_sec = waitMs / 1000;
+  timeout.tv_usec = (waitMs % 1000) * 1000;
+  unsigned long start = micros();
+  int ready = select(maxFd + 1, &readable, &writable, nullptr, &timeout);
+  idleWaiting.store(false);
+  unsigned long now = micros();
+  
+  idleStats.waits++;
+  idleStats.idleMicros += now - start;
+  if (ready <= 0) {
+    idleStats.timeoutWakeups++;
+    return true;
+  }
+  if (wakeSocket >= 0 && FD_ISSET(wakeSocket, &readable)) {
+    uint8_t drain[16];
+    while (recv(wakeSocket, drain, sizeof(drain), MSG_DONTWAIT) > 0) {}
+    idleStats.signalWakeups++;
+    ready--;
+  }
+  if (ready > 0) {
+    idleStats.socketWakeups++;
+    socketReadyAt = now;
+  }
+  return true;
+}
+
+void ESP32S3_EasyConnect::serviceNetwork() {
+  unsigned long loopStart = micros();
+  PERF_BEGIN();
+  
+  // Apply work handed over by application tasks
+  if (networkTask != nullptr) {
+    processOutbound();
+  }
+  PERF_STAGE(PERF_OUTBOUND);
+  
+  server.handleClient();
+  if (bootStats.firstHttpMillis == 0 && server.uri().length() > 0) {
+    // handleClient() answers synchronously, so the first request is done
+    bootStats.firstHttpMillis = millis();
+    logln("⏱️ First HTTP response " + String(bootStats.firstHttpMillis) + " ms after boot");
+  }
+  PERF_STAGE(PERF_HTTP);
+  webSocket.loop();
+  PERF_STAGE(PERF_WEBSOCKET);
+  ElegantOTA.loop();
+  PERF_STAGE(PERF_OTA);
+  
+  // Update uptime
+  deviceUptime = millis();
+  
+  // Fan queued log records out to Serial, telnet and WebSocket
+  drainLog(LOG_DRAIN_BUDGET);
+  PERF_STAGE(PERF_LOG);
+  
+  // Handle Telnet connections and data
+  if (config.enableTelnet) {
+    handleTelnet();
+  }
+  PERF_STAGE(PERF_TELNET);
+  
+  // Handle WiFi reconnection (after the boot-time connection has finished)
+  if (bootWiFiState != BOOT_WIFI_DONE) {
+    pollBootWiFi();
+  } else {
+    serviceWiFiLink();
+  }
+  PERF_STAGE(PERF_WIFI);
+  
+  // Collect results of a running WiFi scan
+  if (scanInProgress) {
+    pollScan();
+  }
+  PERF_STAGE(PERF_SCAN);
+  
+  // Status push, config flush, WiFi retries and telnet idle sweep
+  timers.run(millis());
+  PERF_STAGE(PERF_TIMERS);
+  
+  updateLoopStats(loopStart);
+}
+
+bool ESP32S3_EasyConnect::onNetworkTask() {
+  return networkTask == nullptr || xTaskGetCurrentTaskHandle() == networkTask;
+}
+
+bool ESP32S3_EasyConnect::handOff(NetworkMessage::Target target, const char* data, size_t length,
+                                  uint8_t clientNum, const char* topic, bool binary) {
+  NetworkMessage msg;
+  msg.target = target;
+  msg.clientNum = clientNum;
+  msg.binary = binary;
+  strlcpy(msg.topic, topic, sizeof(msg.topic));
+  msg.length = length;
+  msg.data = (char*)malloc(length + 1);
+  if (msg.data == nullptr) return false;
+  memcpy(msg.data, data, length);
+  msg.data[length] = '\0';
+  
+  if (xQueueSend(outboundQueue, &msg, 0) != pdTRUE) {
+    free(msg.data);
+    return false;
+  }
+  wakeNetwork();
+  return true;
+}
+
+void ESP32S3_EasyConnect::processOutbound() {
+  // Configuration replaced by setConfig() on another task
+  lockConfig();
+  if (pendingConfigSet) {
+    config = pendingConfig;
+    pendingConfigSet = false;
+    unlockConfig();
+    markConfigDirty();
+  } else {
+    unlockConfig();
+  }
+  
+  NetworkMessage msg;
+  while (xQueueReceive(outboundQueue, &msg, 0) == pdTRUE) {
+    if (msg.target == NetworkMessage::WEBSOCKET) {
+      webSocketPublish(resolveTopic(msg.topic), msg.data, msg.length, msg.binary);
+    } else if (msg.target == NetworkMessage::WEBSOCKET_CLIENT) {
+      webSocketSend(msg.clientNum, msg.data, msg.length, msg.binary);
+    } else if (config.enableTelnet) {
+      queueTelnet(msg.data, msg.length);
+    }
+    free(msg.data);
+  }
+}
+
+void ESP32S3_EasyConnect::notifyEvent(FrameworkEvent event) {
+  if (networkTask != nullptr) {
+    xQueueSend(eventQueue, &event, 0);
+  } else {
+    dispatchEvent(event);
+  }
+}
+
+void ESP32S3_EasyConnect::dispatchEvent(FrameworkEvent event) {
+  switch (event) {
+    case EVENT_CONNECTED:
+      connectedHandlers();
+      break;
+    case EVENT_DISCONNECTED:
+      disconnectedHandlers();
+      break;
+    case EVENT_CONFIG_CHANGED:
+      configChangedHandlers();
+      break;
+  }
+}
+
+void ESP32S3_EasyConnect::lockConfig() {
+  if (configMutex != nullptr) xSemaphoreTakeRecursive(configMutex, portMAX_DELAY);
+}
+
+void ESP32S3_EasyConnect::unlockConfig() {
+  if (configMutex != nullptr) xSemaphoreGiveRecursive(configMutex);
+}
+
+void ESP32S3_EasyConnect::updateLoopStats(unsigned long loopStart) {
+  unsigned long now = micros();
+  unsigned long elapsed = now - loopStart;
+  
+  loopStats.iterations++;
+  loopStats.lastLoopMicros = elapsed;
+  if (elapsed > loopStats.maxLoopMicros) {
+    loopStats.maxLoopMicros = elapsed;
+  }
+  
+  // Heap churn: any movement of the free heap between iterations means
+  // something in the loop allocated or released memory
+  uint32_t freeHeap = ESP.getFreeHeap();
+  loopStats.heapChurn += (freeHeap > lastFreeHeap) ? (freeHeap - lastFreeHeap) : (lastFreeHeap - freeHeap);
+  lastFreeHeap = freeHeap;
+  if (freeHeap < loopStats.minFreeHeap) {
+    loopStats.minFreeHeap = freeHeap;
+  }
+  
+  // Iteration rate over one-second windows
+  loopStatsWindowCount++;
+  if (now - loopStatsWindowStart >= 1000000UL) {
+    loopStats.iterationsPerSecond = loopStatsWindowCount;
+    loopStatsWindowCount = 0;
+    loopStatsWindowStart = now;
+  }
+  
+  // Wake-to-served latency for the pass that followed a socket wakeup
+  if (socketReadyAt != 0) {
+    uint32_t served = now - socketReadyAt;
+    idleStats.lastServiceMicros = served;
+    if (served > idleStats.maxServiceMicros) {
+      idleStats.maxServiceMicros = served;
+    }
+    metrics.socketWake.record(served);
+    socketReadyAt = 0;
+  }
+}
+
+void ESP32S3_EasyConnect::setupTelnet() {
+  // Allocate the session pool once; it is sized by setMaxTelnetClients()
+  if (telnetClients == nullptr) {
+    telnetClients = new (std::nothrow) TelnetClient[telnetMaxClients];
+    if (telnetClients == nullptr) {
+      logln("❌ Not enough memory for " + String(telnetMaxClients) + " telnet sessions");
+      return;
+    }
+    telnetSlots = telnetMaxClients;
+    for (int i = 0; i < telnetSlots; i++) {
+      telnetClients[i].connected = false;
+      telnetClients[i].lastActivity = 0;
+      telnetClients[i].input.reset();
+      telnetClients[i].output.reset();
+    }
+  }
+  
+  // Idle sessions are closed by a once-a-second sweep
+  timers.cancel(telnetSweepTimer);
+  telnetSweepTimer = timers.schedule(1000, 1000, [](void* arg) {
+    static_cast<ESP32S3_EasyConnect*>(arg)->expireTelnetClients();
+  }, this);
+  
+  telnetListenFd = listenSocketOpenedBy([this]() { telnetServer.begin(); });
+  telnetServer.setNoDelay(true);
+  telnetEnabled = true;
+  
+  log("✅ Telnet server started on port ");
+  logln(String(config.telnetPort));
+  logln("💡 Connect using: telnet " + WiFi.localIP().toString());
+}
+
+void TelnetLineBuffer::reset() {
+  length = 0;
+  data[0] = '\0';
+  skipLF = false;
+  overflowed = false;
+  iacState = 0;
+}
+
+TelnetLineBuffer::Result TelnetLineBuffer::feed(uint8_t c) {
+  // Skip telnet option negotiation (IAC WILL/WONT/DO/DONT <option>)
+  if (iacState > 0) {
+    if (iacState == 1 && c >= 251 && c <= 254) {
+      iacState = 2;
+    } else {
+      iacState = 0;
+    }
+    return PENDING;
+  }
+  if (c == 255) {
+    iacState = 1;
+    return PENDING;
+  }
+  
+  // Line terminators: LF, CR or CRLF
+  if (c == '\n' && skipLF) {
+    skipLF = false;
+    return PENDING;
+  }
+  skipLF = (c == '\r');
+  if (c == '\r' || c == '\n') {
+    data[length] = '\0';
+    if (overflowed) {
+      length = 0;
+      overflowed = false;
+      return OVERFLOW;
+    }
+    return LINE;
+  }
+  
+  // Backspace/delete from character-mode clients
+  if (c == 0x08 || c == 0x7F) {
+    if (length > 0 && !overflowed) {
+      length--;
+    }
+    return PENDING;
+  }
+  
+  // Drop remaining control characters
+  if (c < 0x20 && c != '\t') {
+    return PENDING;
+  }
+  
+  if (length >= CAPACITY - 1) {
+    overflowed = true;
+    return PENDING;
+  }
+  data[length++] = (char)c;
+  return PENDING;
+}
+
+void ESP32S3_EasyConnect::setMaxTelnetClients(int maxClients) {
+  if (telnetClients != nullptr) {
+    logln("⚠️ setMaxTelnetClients() must be called before begin()");
+    return;
+  }
+  telnetMaxClients = constrain(maxClients, 1, (int)TELNET_CLIENT_LIMIT);
+}
+
+void ESP32S3_EasyConnect::handleTelnet() {
+  if (telnetSlots == 0) return;
+  telnetBacklog = false;
+  
+  // Check for new connections
+  if (telnetServer.hasClient()) {
+    acceptTelnetClient();
+  }
+  if (telnetClientCount == 0) return;
+  
+  // One select() over all live sockets; only ready ones are read or written
+  fd_set readable;
+  fd_set writable;
+  FD_ZERO(&readable);
+  FD_ZERO(&writable);
+  int maxFd = -1;
+  for (int i = 0; i < telnetSlots; i++) {
+    TelnetClient& tc = telnetClients[i];
+    if (!tc.connected) continue;
+    
+    int fd = tc.client.fd();
+    if (fd < 0) {
+      // Socket already closed after a hard send error
+      logln("🔌 Telnet client disconnected (socket error)");
+      releaseTelnetClient(i);
+      continue;
+    }
+    FD_SET(fd, &readable);
+    if (tc.output.count > 0 || tc.output.pendingNotice > 0) {
+      FD_SET(fd, &writable);
+    }
+    if (fd > maxFd) maxFd = fd;
+  }
+  if (maxFd < 0) return;
+  
+  struct timeval noWait = {0, 0};
+  if (select(maxFd + 1, &readable, &writable, nullptr, &noWait) <= 0) {
+    // Nothing ready on the sockets, but WiFiClient may still hold received bytes
+    FD_ZERO(&readable);
+    FD_ZERO(&writable);
+  }
+  
+  for (int i = 0; i < telnetSlots; i++) {
+    TelnetClient& tc = telnetClients[i];
+    if (!tc.connected) continue;
+    
+    int fd = tc.client.fd();
+    bool wasRead = false;
+    if (FD_ISSET(fd, &readable) || tc.backlog || tc.client.available() > 0) {
+      readTelnetClient(i);
+      wasRead = true;
+      if (!tc.connected) continue;
+    }
+    
+    // Push queued output without blocking on slow peers; replies to
+    // commands read above go out in the same pass
+    if (FD_ISSET(fd, &writable) || (wasRead && tc.output.count > 0)) {
+      flushTelnetClient(i);
+    }
+  }
+}
+
+void ESP32S3_EasyConnect::expireTelnetClients() {
+  unsigned long now = millis();
+  for (int i = 0; i < telnetSlots; i++) {
+    TelnetClient& tc = telnetClients[i];
+    if (tc.connected && now - tc.lastActivity > TELNET_IDLE_TIMEOUT) {
+      log("⏰ Telnet client timeout: ");
+      logln(tc.client.remoteIP().toString());
+      closeTelnetClient(i, "⏰ Connection timeout. Goodbye!\r\n");
+    }
+  }
+}
+
+void ESP32S3_EasyConnect::acceptTelnetClient() {
+  if (telnetClientCount >= telnetSlots) {
+    // No free slots, reject connection
+    WiFiClient client = telnetServer.available();
+    client.print("❌ Maximum telnet clients reached (" + String(telnetSlots) + "). Try again later.\r\n");
+    client.stop();
+    logln("⚠️ Telnet connection rejected - maximum clients reached");
+    return;
+  }
+  
+  int i = 0;
+  while (telnetClients[i].connected) i++;
+  TelnetClient& tc = telnetClients[i];
+  if (tc.client) {
+    tc.client.stop();
+  }
+  
+  tc.client = telnetServer.available();
+  tc.connected = true;
+  tc.backlog = false;
+  tc.lastActivity = millis();
+  tc.input.reset();
+  tc.output.reset();
+  telnetClientCount++;
+  
+  // Send welcome message
+  String welcome = "\r\n";
+  welcome += "┌────────────────────────────────────────┐\r\n";
+  welcome += "│       ESP32-S3 EasyConnect Telnet     │\r\n";
+  welcome += "│              Framework v1.2.0         │\r\n";
+  welcome += "└────────────────────────────────────────┘\r\n";
+  welcome += "Device: " + config.deviceName + "\r\n";
+  welcome += "IP: " + WiFi.localIP().toString() + "\r\n";
+  welcome += "Free Heap: " + String(ESP.getFreeHeap()) + " bytes\r\n";
+  welcome += "Uptime: " + String(deviceUptime / 1000) + "s\r\n";
+  welcome += "Connected clients: " + String(telnetClientCount) + "/" + String(telnetSlots) + "\r\n";
+  welcome += "Type 'help' for available commands\r\n";
+  welcome += "----------------------------------------\r\n";
+  welcome += "> ";
+  
+  sendToTelnetClient(i, welcome);
+  
+  log("🔌 Telnet client connected from: ");
+  logln(tc.client.remoteIP().toString());
+}
+
+// Drain available bytes from a readable socket without waiting for a full line
+void ESP32S3_EasyConnect::readTelnetClient(int clientIndex) {
+  TelnetClient& tc = telnetClients[clientIndex];
+  uint8_t rx[64];
+  int budget = TELNET_RX_BUDGET;
+  bool received = false;
+  while (budget > 0 && tc.connected) {
+    int avail = tc.client.available();
+    if (avail <= 0) break;
+    
+    size_t toRead = min((size_t)avail, min(sizeof(rx), (size_t)budget));
+    int n = tc.client.read(rx, toRead);
+    if (n <= 0) break;
+    budget -= n;
+    received = true;
+    metrics.bytesIn[TRANSPORT_TELNET].fetch_add(n, std::memory_order_relaxed);
+    
+    for (int k = 0; k < n && tc.connected; k++) {
+      TelnetLineBuffer::Result result = tc.input.feed(rx[k]);
+      
+      if (result == TelnetLineBuffer::LINE) {
+        String command(tc.input.data);
+        tc.input.length = 0;
+        processTelnetCommand(clientIndex, command);
+      } else if (result == TelnetLineBuffer::OVERFLOW) {
+        tc.lastActivity = millis();
+        sendToTelnetClient(clientIndex, "❌ Line too long (max " + String(TelnetLineBuffer::CAPACITY - 1) + " characters)\r\n> ");
+      }
+    }
+  }
+  
+  // The rest may already sit in WiFiClient, invisible to select(): read it next pass
+  tc.backlog = budget <= 0;
+  if (tc.backlog) {
+    telnetBacklog = true;
+  }
+  
+  // Readable without data: the peer closed the connection
+  if (!received && tc.connected && !tc.client.connected()) {
+    log("🔌 Telnet client disconnected: ");
+    logln(tc.client.remoteIP().toString());
+    releaseTelnetClient(clientIndex);
+  }
+}
+
+void ESP32S3_EasyConnect::releaseTelnetClient(int clientIndex) {
+  TelnetClient& tc = telnetClients[clientIndex];
+  if (!tc.connected) return;
+  tc.client.stop();
+  tc.connected = false;
+  telnetClientCount--;
+}
+
+void ESP32S3_EasyConnect::processTelnetCommand(int clientIndex, String command) {
+  TelnetClient& tc = telnetClients[clientIndex];
+  command.trim();
+  
+  if (command.length() == 0) {
+    return;
+  }
+  
+  tc.lastActivity = millis();
+  
+  log("📨 Telnet command from ");
+  log(tc.client.remoteIP().toString());
+  log(": ");
+  logln(command);
+  
+  CommandContext ctx;
+  ctx.source = COMMAND_TELNET;
+  ctx.client = clientIndex;
+  if (dispatchCommand(ctx, command)) {
+    return;
+  }
+  
+  // Pass command to custom subscribers if any
+  if (!telnetCommandHandlers.empty()) {
+    telnetCommandHandlers(command, tc.client);
+  } else {
+    sendToTelnetClient(clientIndex, "❌ Unknown command. Type 'help' for available commands.\r\n> ");
+  }
+}
+
+CommandRegistry::CommandRegistry() {
+  memset(table, 0, sizeof(table));
+}
+
+uint32_t CommandRegistry::hash(const char* name, size_t length) {
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ (uint8_t)name[i]) * 16777619u;
+  }
+  return h;
+}
+
+bool CommandRegistry::add(const char* name, const char* usage, const char* help, CommandPermission permission,
+                          CommandHandler handler, void* userData) {
+  if (name == nullptr || handler == nullptr) return false;
+  
+  size_t length = strlen(name);
+  uint32_t h = hash(name, length);
+  size_t slot = h & (TABLE_SIZE - 1);
+  while (table[slot] != 0) {
+    CommandEntry& existing = entries[table[slot] - 1];
+    if (existing.hash == h && strcmp(existing.name, name) == 0) {
+      // Same name registered again replaces the handler
+      existing.usage = usage;
+      existing.help = help;
+      existing.permission = permission;
+      existing.handler = handler;
+      existing.userData = userData;
+      return true;
+    }
+    slot = (slot + 1) & (TABLE_SIZE - 1);
+  }
+  
+  if (count >= MAX_COMMANDS) return false;
+  entries[count] = {name, usage != nullptr ? usage : "", help, h, permission, handler, userData, 0, 0};
+  table[slot] = ++count;
+  return true;
+}
+
+CommandEntry* CommandRegistry::find(const char* name, size_t length) {
+  uint32_t h = hash(name, length);
+  size_t slot = h & (TABLE_SIZE - 1);
+  while (table[slot] != 0) {
+    CommandEntry& entry = entries[table[slot] - 1];
+    if (entry.hash == h && strncmp(entry.name, name, length) == 0 && entry.name[length] == '\0') {
+      return &entry;
+    }
+    slot = (slot + 1) & (TABLE_SIZE - 1);
+  }
+  return nullptr;
+}
+
+bool ESP32S3_EasyConnect::registerCommand(const char* name, const char* usage, const char* help,
+                                          CommandPermission permission, CommandHandler handler, void* userData) {
+  if (!commands.add(name, usage, help, permission, handler, userData)) {
+    logln("⚠️ Command table full, '" + String(name) + "' not registered");
+    return false;
+  }
+  return true;
+}
+
+void ESP32S3_EasyConnect::setCommandPermission(CommandSource source, CommandPermission permission) {
+  sourcePermission[source] = permission;
+}
+
+// Tokenize a command line, look it up and run it; false when no command matches
+bool ESP32S3_EasyConnect::dispatchCommand(CommandContext& ctx, const String& line) {
+  char buffer[CommandContext::LINE_SIZE];
+  strlcpy(buffer, line.c_str(), sizeof(buffer));
+  
+  char* p = buffer;
+  while (*p == ' ') p++;
+  char* name = p;
+  while (*p != '\0' && *p != ' ') p++;
+  CommandEntry* entry = commands.find(name, p - name);
+  if (entry == nullptr) {
+    return false;
+  }
+  
+  ctx.permission = sourcePermission[ctx.source];
+  ctx.reply = "";
+  ctx.ok = true;
+  ctx.delivered = false;
+  ctx.argc = 0;
+  while (*p == ' ') p++;
+  ctx.rest = line.c_str() + (p - buffer);
+  while (*p != '\0' && ctx.argc < CommandContext::MAX_ARGS) {
+    ctx.argv[ctx.argc++] = p;
+    while (*p != '\0' && *p != ' ') p++;
+    if (*p != '\0') *p++ = '\0';
+    while (*p == ' ') p++;
+  }
+  
+  if (line.length() >= CommandContext::LINE_SIZE) {
+    ctx.ok = false;
+    ctx.reply = "❌ Command too long (max " + String(CommandContext::LINE_SIZE - 1) + " characters)\r\n";
+  } else if (entry->permission > ctx.permission) {
+    ctx.ok = false;
+    ctx.reply = "❌ Permission denied for '" + String(entry->name) + "'\r\n";
+  } else {
+    unsigned long started = micros();
+    entry->handler(ctx, entry->userData);
+    uint32_t elapsed = micros() - started;
+    entry->calls++;
+    entry->micros += elapsed;
+    metrics.commands[ctx.source].record(elapsed);
+  }
+  
+  sendCommandReply(ctx);
+  return true;
+}
+
+// Deliver the reply in the caller's format; handlers call this early before restarting
+void ESP32S3_EasyConnect::sendCommandReply(CommandContext& ctx) {
+  if (ctx.delivered) return;
+  ctx.delivered = true;
+  
+  if (ctx.source == COMMAND_TELNET) {
+    ctx.reply += "> ";
+    sendToTelnetClient(ctx.client, ctx.reply);
+    return;
+  }
+  
+  StaticJsonDocument<JSON_OBJECT_SIZE(3)> doc;
+  doc["type"] = "commandResult";
+  doc["ok"] = ctx.ok;
+  doc["output"] = ctx.reply.c_str();
+  String response;
+  serializeJson(doc, response);
+  
+  if (ctx.source == COMMAND_WEBSOCKET) {
+    webSocketSend(ctx.client, response.c_str(), response.length());
+  } else {
+    server.send(ctx.ok ? 200 : 400, "application/json", response);
+  }
+}
+
+void ESP32S3_EasyConnect::registerBuiltinCommands() {
+  // Handlers receive the framework instance as userData
+  void* self = this;
+  
+  registerCommand("help", "", "Show this help", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    ctx.reply = "Available commands:\r\n";
+    for (int i = 0; i < ec->commands.size(); i++) {
+      const CommandEntry& entry = ec->commands.at(i);
+      if (entry.help == nullptr || entry.permission > ctx.permission) continue;
+      String synopsis = String("  ") + entry.name;
+      if (entry.usage[0] != '\0') {
+        synopsis += " ";
+        synopsis += entry.usage;
+      }
+      while (synopsis.length() < 24) synopsis += ' ';
+      ctx.reply += synopsis + " - " + entry.help + "\r\n";
+    }
+  }, self);
+  registerCommand("?", "", nullptr, PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    static_cast<ESP32S3_EasyConnect*>(arg)->commands.find("help", 4)->handler(ctx, arg);
+  }, self);
+  
+  registerCommand("status", "", "Show device status", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    ctx.reply = "Device Status:\r\n";
+    ctx.reply += "  Name: " + ec->config.deviceName + "\r\n";
+    ctx.reply += "  Uptime: " + String(ec->deviceUptime / 1000) + "s\r\n";
+    ctx.reply += "  Free Heap: " + String(ESP.getFreeHeap()) + " bytes\r\n";
+    ctx.reply += "  WiFi: " + String(WiFi.SSID()) + " (" + String(WiFi.RSSI()) + " dBm)\r\n";
+    ctx.reply += "  IP: " + WiFi.localIP().toString() + "\r\n";
+    ctx.reply += "  Telnet clients: " + String(ec->getTelnetClientCount()) + "/" + String(ec->telnetMaxClients) + "\r\n";
+  }, self);
+  
+  registerCommand("restart", "", "Restart device", PERMISSION_ADMIN, [](CommandContext& ctx, void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    ctx.reply = "🔄 Restarting device...\r\n";
+    ec->sendCommandReply(ctx);
+    if (ctx.source == COMMAND_TELNET) ec->flushTelnetClient(ctx.client);
+    delay(1000);
+    ec->restartDevice();
+  }, self);
+  
+  registerCommand("factoryreset", "", "Factory reset", PERMISSION_ADMIN, [](CommandContext& ctx, void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    ctx.reply = "🗑️ Factory reset...\r\n";
+    ec->sendCommandReply(ctx);
+    if (ctx.source == COMMAND_TELNET) ec->flushTelnetClient(ctx.client);
+    delay(1000);
+    ec->factoryReset();
+  }, self);
+  
+  registerCommand("clients", "", "Show connected clients", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    ctx.reply = "Connected Telnet Clients:\r\n";
+    for (int j = 0; j < ec->telnetSlots; j++) {
+      TelnetClient& tc = ec->telnetClients[j];
+      if (tc.connected && tc.client.connected()) {
+        ctx.reply += "  " + String(j+1) + ". " + tc.client.remoteIP().toString() + 
+                     " (active " + String((millis() - tc.lastActivity) / 1000) + "s ago, " +
+                     String(tc.output.droppedBytes) + " bytes dropped)\r\n";
+      }
+    }
+  }, self);
+  
+  registerCommand("wifi", "", "Show WiFi info", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ctx.reply = "WiFi Information:\r\n";
+    ctx.reply += "  SSID: " + String(WiFi.SSID()) + "\r\n";
+    ctx.reply += "  IP: " + WiFi.localIP().toString() + "\r\n";
+    ctx.reply += "  MAC: " + String(WiFi.macAddress()) + "\r\n";
+    ctx.reply += "  RSSI: " + String(WiFi.RSSI()) + " dBm\r\n";
+    ctx.reply += "  Channel: " + String(WiFi.channel()) + "\r\n";
+  }, self);
+  
+  registerCommand("memory", "", "Show memory usage", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ctx.reply = "Memory Information:\r\n";
+    ctx.reply += "  Free Heap: " + String(ESP.getFreeHeap()) + " bytes\r\n";
+    ctx.reply += "  Min Free Heap: " + String(ESP.getMinFreeHeap()) + " bytes\r\n";
+    ctx.reply += "  Max Alloc Heap: " + String(ESP.getMaxAllocHeap()) + " bytes\r\n";
+    ctx.reply += "  PSRAM Size: " + String(ESP.getPsramSize()) + " bytes\r\n";
+    ctx.reply += "  Free PSRAM: " + String(ESP.getFreePsram()) + " bytes\r\n";
+  }, self);
+  
+  registerCommand("config", "", "Show current configuration", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ctx.reply = "Current Configuration:\r\n";
+    ctx.reply += describeConfig(static_cast<ESP32S3_EasyConnect*>(arg)->config);
+  }, self);
+  
+  registerCommand("stats", "[reset]", "Show loop statistics", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    if (strcmp(ctx.arg(0), "reset") == 0) {
+      if (ctx.permission < PERMISSION_OPERATOR) {
+        ctx.ok = false;
+        ctx.reply = "❌ Permission denied for 'stats reset'\r\n";
+        return;
+      }
+      ec->resetLoopStats();
+    }
+    ctx.reply = ec->describeStats();
+  }, self);
+  
+#if EASYCONNECT_PROFILING
+  registerCommand("perf", "[reset]", "Show loop time per stage (p50/p99/max)", PERMISSION_VIEWER,
+                  [](CommandContext& ctx, void* arg) {
+    ESP32S3_EasyConnect* ec = static_cast<ESP32S3_EasyConnect*>(arg);
+    if (strcmp(ctx.arg(0), "reset") == 0) {
+      if (ctx.permission < PERMISSION_OPERATOR) {
+        ctx.ok = false;
+        ctx.reply = "❌ Permission denied for 'perf reset'\r\n";
+        return;
+      }
+      ec->resetLoopProfile();
+    }
+    ctx.reply = ec->describeLoopProfile();
+  }, self);
+#endif
+  
+  registerCommand("clear", "", "Clear screen", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    // Clear screen and move to home (ANSI escape codes)
+    ctx.reply = "\033[2J\033[H";
+  }, self);
+  registerCommand("cls", "", nullptr, PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    ctx.reply = "\033[2J\033[H";
+  }, self);
+  
+  registerCommand("disconnect", "", "Disconnect this session", PERMISSION_VIEWER, [](CommandContext& ctx, void* arg) {
+    if (ctx.source != COMMAND_TELNET) {
+      ctx.ok = false;
+      ctx.reply = "❌ Only available over telnet\r\n";
+      return;
+    }
+    static_cast<ESP32S3_EasyConnect*>(arg)->closeTelnetClient(ctx.client, "👋 Disconnecting...\r\n");
+    ctx.delivered = true;
+  }, self);
+}
+
+String ESP32S3_EasyConnect::describeStats() {
+  String statsInfo = "Loop Statistics:\r\n";
+  statsInfo += "  Iterations: " + String(loopStats.iterations) + "\r\n";
+  statsInfo += "  Loops/sec: " + String(loopStats.iterationsPerSecond) + "\r\n";
+  statsInfo += "  Last Loop: " + String(loopStats.lastLoopMicros) + " us\r\n";
+  statsInfo += "  Max Loop: " + String(loopStats.maxLoopMicros) + " us\r\n";
+  statsInfo += "  Min Free Heap: " + String(loopStats.minFreeHeap) + " bytes\r\n";
+  statsInfo += "  Heap Churn: " + String(loopStats.heapChurn) + " bytes\r\n";
+  unsigned long idleWindow = millis() - idleStatsSince;
+  float idlePercent = idleWindow > 0 ? idleStats.idleMicros / (idleWindow * 10.0f) : 0;
+  statsInfo += "  Idle: " + String(idlePercent, 1) + "% (" + String(idleStats.waits) + " waits: " +
+               String(idleStats.socketWakeups) + " socket, " +
+               String(idleStats.signalWakeups) + " signal, " +
+               String(idleStats.timeoutWakeups) + " timeout), socket served after " +
+               String(idleStats.lastServiceMicros) + " us / max " + String(idleStats.maxServiceMicros) + " us\r\n";
+  statsInfo += "  Status Stream: " + String(statusStats.deltasSent) + " deltas, " +
+               String(statusStats.snapshotsSent) + " snapshots, " +
+               String(statusStats.ticksSuppressed) + " suppressed, " +
+               String(statusStats.bytesSent) + " bytes\r\n";
+  statsInfo += "  WebSocket Frames: " + String(webSocketStats.unicastFrames) + " unicast, " +
+               String(webSocketStats.broadcastFrames) + " broadcast (" +
+               String(webSocketStats.broadcastDeliveries) + " deliveries)\r\n";
+  TelemetryStats telemetryStats = getTelemetryStats();
+  statsInfo += "  Telemetry: " + String(telemetryStats.frames) + " frames, " +
+               String(telemetryStats.bytes) + " bytes MessagePack in " + String(telemetryStats.encodeMicros) + " us";
+  if (telemetryComparison) {
+    statsInfo += " (JSON: " + String(telemetryStats.jsonBytes) + " bytes in " + String(telemetryStats.jsonMicros) + " us)";
+  }
+  statsInfo += "\r\n";
+  statsInfo += "  Boot: WiFi after " + String(bootStats.wifiConnectedMillis) + " ms (" +
+               String(!bootStats.fastConnect ? "normal" : bootStats.fastConnectFailed ? "fast connect failed" : "fast connect") +
+               "), first HTTP response after " + String(bootStats.firstHttpMillis) + " ms\r\n";
+  statsInfo += "  WiFi Link: " + String(wifiLinkStats.disconnects) + " disconnects, " +
+               String(wifiLinkStats.reconnectAttempts) + " attempts, " +
+               String(wifiLinkStats.roams) + " roams, " +
+               String(wifiLinkStats.portalStarts) + " portals, outage last " +
+               String(wifiLinkStats.lastOutageMillis) + " ms / max " +
+               String(wifiLinkStats.longestOutageMillis) + " ms / total " +
+               String(wifiLinkStats.totalOutageMillis) + " ms\r\n";
+  statsInfo += "  Config Store: " + String(configStoreStats.saveRequests) + " save requests, " +
+               String(configStoreStats.flashWrites) + " flash writes, " +
+               String(configStoreStats.writesAvoided) + " avoided, " +
+               String(configStoreStats.corruptSlots) + " corrupt slots\r\n";
+  AssetStats assetStats = assetHandler.getStats();
+  statsInfo += "  Assets: " + String(assetStats.requests) + " requests, " +
+               String(assetStats.notModified) + " not modified, " +
+               String(assetStats.fromFlash) + " from firmware, " +
+               String(assetStats.fileOpens) + " file opens, " +
+               String(assetStats.bytesSent) + " bytes\r\n";
+  return statsInfo;
+}
+
+void ESP32S3_EasyConnect::broadcastTelnet(String message) {
+  if (!onNetworkTask()) {
+    handOff(NetworkMessage::TELNET, message.c_str(), message.length());
+    return;
+  }
+  if (!config.enableTelnet) return;
+  
+  queueTelnet(message.c_str(), message.length());
+}
+
+void ESP32S3_EasyConnect::setTelnetOverflowPolicy(TelnetOverflowPolicy policy) {
+  telnetOverflowPolicy = policy;
+}
+
+void ESP32S3_EasyConnect::queueTelnet(const char* data, size_t length) {
+  if (length == 0) return;
+  for (int i = 0; i < telnetSlots; i++) {
+    if (telnetClients[i].connected) {
+      sendToTelnetClient(i, data, length);
+    }
+  }
+}
+
+void ESP32S3_EasyConnect::sendToTelnetClient(int clientIndex, const String& message) {
+  sendToTelnetClient(clientIndex, message.c_str(), message.length());
+}
+
+void ESP32S3_EasyConnect::sendToTelnetClient(int clientIndex, const char* data, size_t length) {
+  TelnetClient& tc = telnetClients[clientIndex];
+  if (!tc.connected) return;
+  
+  const uint8_t* bytes = (const uint8_t*)data;
+  size_t len = length;
+  TelnetOutputQueue& out = tc.output;
+  
+  if (len > out.space()) {
+    switch (telnetOverflowPolicy) {
+      case TELNET_DROP_OLDEST:
+        // Keep only the newest CAPACITY bytes of the combined stream
+        if (len > TelnetOutputQueue::CAPACITY) {
+          out.droppedBytes += len - TelnetOutputQueue::CAPACITY;
+          bytes += len - TelnetOutputQueue::CAPACITY;
+          len = TelnetOutputQueue::CAPACITY;
+        }
+        out.droppedBytes += len - out.space();
+        out.discard(len - out.space());
+        break;
+        
+      case TELNET_DROP_CLIENT: {
+        // Mark the slot free before logging, which fans out to telnet again
+        String ip = tc.client.remoteIP().toString();
+        out.droppedBytes += out.count + len;
+        releaseTelnetClient(clientIndex);
+        log("⚠️ Telnet client too slow, disconnected: ");
+        logln(ip);
+        return;
+      }
+        
+      case TELNET_COALESCE:
+        out.droppedBytes += len;
+        out.pendingNotice += len;
+        return;
+    }
+  }
+  
+  out.push(bytes, len);
+}
+
+bool ESP32S3_EasyConnect::flushTelnetClient(int clientIndex) {
+  TelnetClient& tc = telnetClients[clientIndex];
+  TelnetOutputQueue& out = tc.output;
+  if (!tc.connected) return true;
+  
+  // Report coalesced drops once there is room again
+  if (out.pendingNotice > 0) {
+    String notice = "\r\n[... " + String(out.pendingNotice) + " bytes dropped ...]\r\n";
+    if (notice.length() <= out.space()) {
+      out.pendingNotice = 0;
+      out.push((const uint8_t*)notice.c_str(), notice.length());
+    }
+  }
+  
+  int fd = tc.client.fd();
+  while (out.count > 0) {
+    size_t chunk = min(out.count, TelnetOutputQueue::CAPACITY - out.head);
+    int sent = send(fd, out.data + out.head, chunk, MSG_DONTWAIT);
+    if (sent > 0) {
+      out.discard(sent);
+      metrics.bytesOut[TRANSPORT_TELNET].fetch_add(sent, std::memory_order_relaxed);
+      continue;
+    }
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return false;  // Send window full, retry next loop
+    }
+    // Hard socket error; the slot is released by handleTelnet()
+    tc.client.stop();
+    return false;
+  }
+  return true;
+}
+
+void ESP32S3_EasyConnect::closeTelnetClient(int clientIndex, const char* farewell) {
+  if (farewell != nullptr) {
+    sendToTelnetClient(clientIndex, farewell);
+    flushTelnetClient(clientIndex);
+  }
+  releaseTelnetClient(clientIndex);
+}
+
+void TelnetOutputQueue::reset() {
+  head = 0;
+  count = 0;
+  droppedBytes = 0;
+  pendingNotice = 0;
+}
+
+void TelnetOutputQueue::push(const uint8_t* bytes, size_t len) {
+  size_t tail = (head + count) % CAPACITY;
+  size_t first = min(len, CAPACITY - tail);
+  memcpy(data + tail, bytes, first);
+  memcpy(data, bytes + first, len - first);
+  count += len;
+}
+
+void TelnetOutputQueue::discard(size_t len) {
+  head = (head + len) % CAPACITY;
+  count -= len;
+}
+
+void ESP32S3_EasyConnect::sendToTelnet(String message) {
+  if (!config.enableTelnet) return;
+  broadcastTelnet(message);
+}
+
+// Enhanced logging system: producers copy into the preallocated log ring,
+// loop() fans records out to Serial, telnet and WebSocket
+void ESP32S3_EasyConnect::log(const char* message) {
+  writeLog(LOGLEVEL_INFO, "", message, strlen(message), false);
+}
+
+void ESP32S3_EasyConnect::log(const String& message) {
+  writeLog(LOGLEVEL_INFO, "", message.c_str(), message.length(), false);
+}
+
+void ESP32S3_EasyConnect::logln(const char* message) {
+  writeLog(LOGLEVEL_INFO, "", message, strlen(message), true);
+}
+
+void ESP32S3_EasyConnect::logln(const String& message) {
+  writeLog(LOGLEVEL_INFO, "", message.c_str(), message.length(), true);
+}
+
+void ESP32S3_EasyConnect::logf(const char* format, ...) {
+  uint32_t ticket;
+  LogRecord* record = logRing.claim(ticket);
+  if (record == nullptr) return;
+  
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(record->payload, sizeof(record->payload), format, args);
+  va_end(args);
+  
+  record->timestamp = millis();
+  record->level = LOGLEVEL_INFO;
+  record->newline = false;
+  record->length = (n < 0) ? 0 : min((size_t)n, sizeof(record->payload) - 1);
+  record->tag[0] = '\0';
+  logRing.commit(ticket);
+  wakeNetwork();
+}
+
+void ESP32S3_EasyConnect::logEvent(LogLevel level, const char* tag, const char* format, ...) {
+  uint32_t ticket;
+  LogRecord* record = logRing.claim(ticket);
+  if (record == nullptr) return;
+  
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(record->payload, sizeof(record->payload), format, args);
+  va_end(args);
+  
+  record->timestamp = millis();
+  record->level = level;
+  record->newline = true;
+  record->length = (n < 0) ? 0 : min((size_t)n, sizeof(record->payload) - 1);
+  strlcpy(record->tag, tag, sizeof(record->tag));
+  logRing.commit(ticket);
+  wakeNetwork();
+}
+
+void IRAM_ATTR ESP32S3_EasyConnect::logFromISR(LogLevel level, const char* tag, const char* message) {
+  // No formatting here: vsnprintf is not ISR-safe
+  size_t length = 0;
+  while (message[length] != '\0') length++;
+  writeLog(level, tag, message, length, true);
+}
+
+void IRAM_ATTR ESP32S3_EasyConnect::writeLog(LogLevel level, const char* tag, const char* message, size_t length, bool newline) {
+  uint32_t ticket;
+  LogRecord* record = logRing.claim(ticket);
+  if (record == nullptr) return;
+  
+  if (length > sizeof(record->payload) - 1) {
+    length = sizeof(record->payload) - 1;
+  }
+  memcpy(record->payload, message, length);
+  record->payload[length] = '\0';
+  
+  size_t t = 0;
+  for (; t < sizeof(record->tag) - 1 && tag[t] != '\0'; t++) {
+    record->tag[t] = tag[t];
+  }
+  record->tag[t] = '\0';
+  
+  record->timestamp = millis();
+  record->level = level;
+  record->newline = newline;
+  record->length = length;
+  logRing.commit(ticket);
+  if (!xPortInIsrContext()) {
+    wakeNetwork();  // Records from ISRs wait for the next wakeup
+  }
+}
+
+void ESP32S3_EasyConnect::drainLog(size_t maxRecords) {
+  static const char* const levelNames[] = { "debug", "info", "warn", "error" };
+  
+  const LogRecord* record;
+  while (maxRecords-- > 0 && (record = logRing.peek()) != nullptr) {
+    char prefix[LogRecord::TAG_SIZE + 4];
+    size_t prefixLength = 0;
+    if (record->tag[0] != '\0') {
+      prefixLength = snprintf(prefix, sizeof(prefix), "[%s] ", record->tag);
+    }
+    
+    // Serial sink
+    Serial.write((const uint8_t*)prefix, prefixLength);
+    Serial.write((const uint8_t*)record->payload, record->length);
+    if (record->newline) Serial.write((const uint8_t*)"\r\n", 2);
+    
+    // Telnet sink (per-client queues)
+    if (config.enableTelnet) {
+      queueTelnet(prefix, prefixLength);
+      queueTelnet(record->payload, record->length);
+      if (record->newline) queueTelnet("\r\n", 2);
+    }
+    
+    // WebSocket sink
+    if (webSocketLogging) {
+      char frame[LogRecord::PAYLOAD_SIZE * 2 + 96];
+      size_t n = snprintf(frame, sizeof(frame), "{\"type\":\"log\",\"ts\":%u,\"level\":\"%s\",\"tag\":\"%s\",\"msg\":\"",
+                          (unsigned)record->timestamp, levelNames[record->level & 3], record->tag);
+      for (size_t k = 0; k < record->length && n < sizeof(frame) - 8; k++) {
+        char c = record->payload[k];
+        if (c == '"' || c == '\\') {
+          frame[n++] = '\\';
+          frame[n++] = c;
+        } else if (c == '\n') {
+          frame[n++] = '\\';
+          frame[n++] = 'n';
+        } else if ((uint8_t)c >= 0x20) {
+          frame[n++] = c;
+        }
+      }
+      frame[n++] = '"';
+      frame[n++] = '}';
+      webSocketPublish(topicLog, frame, n);
+    }
+    
+    logRing.release();
+  }
+}
+
+void ESP32S3_EasyConnect::flushLog() {
+  // The log ring has a single consumer: the task running serviceNetwork()
+  if (!onNetworkTask()) return;
+  drainLog(LogRing::SLOTS);
+  for (int i = 0; i < telnetSlots; i++) {
+    flushTelnetClient(i);
+  }
+}
+
+void ESP32S3_EasyConnect::setWebSocketLogging(bool enabled) {
+  webSocketLogging = enabled;
+}
+
+uint32_t ESP32S3_EasyConnect::getDroppedLogCount() {
+  return logRing.dropped();
+}
+
+LogRing::LogRing() : writePos(0), droppedCount(0), readPos(0) {
+  for (uint32_t i = 0; i < SLOTS; i++) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+LogRecord* IRAM_ATTR LogRing::claim(uint32_t& ticket) {
+  uint32_t pos = writePos.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = slots[pos & (SLOTS - 1)];
+    int32_t diff = (int32_t)(slot.sequence.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        ticket = pos;
+        return &slot.record;
+      }
+    } else if (diff < 0) {
+      // Consumer has not released this slot yet: ring is full
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      pos = writePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void IRAM_ATTR LogRing::commit(uint32_t ticket) {
+  slots[ticket & (SLOTS - 1)].sequence.store(ticket + 1, std::memory_order_release);
+}
+
+const LogRecord* LogRing::peek() {
+  Slot& slot = slots[readPos & (SLOTS - 1)];
+  if (slot.sequence.load(std::memory_order_acquire) != readPos + 1) {
+    return nullptr;
+  }
+  return &slot.record;
+}
+
+void LogRing::release() {
+  slots[readPos & (SLOTS - 1)].sequence.store(readPos + SLOTS, std::memory_order_release);
+  readPos++;
+}
+
+// FNV-1a; evaluated at compile time for the schema keys
+static constexpr uint32_t configKeyHash(const char* key, uint32_t hash = 2166136261u) {
+  return *key ? configKeyHash(key + 1, (hash ^ (uint8_t)*key) * 16777619u) : hash;
+}
+
+// Schema limits for one field; every way into the config goes through these
+static void clampConfigValue(String& field, double, double maxLength) {
+  if (field.length() > maxLength) field.remove((unsigned int)maxLength);
+}
+
+static void clampConfigValue(bool&, double, double) {}
+
+static void clampConfigValue(int& field, double minValue, double maxValue) {
+  field = (int)constrain((double)field, minValue, maxValue);
+}
+
+static void clampConfigValue(float& field, double minValue, double maxValue) {
+  field = (float)constrain((double)field, minValue, maxValue);
+}
+
+// Typed setters used by readConfigJson(); wrong JSON types are ignored
+static bool applyConfigValue(String& field, JsonVariantConst value, double minValue, double maxLength) {
+  if (!value.is<const char*>()) return false;
+  field = value.as<const char*>();
+  clampConfigValue(field, minValue, maxLength);
+  return true;
+}
+
+static bool applyConfigValue(bool& field, JsonVariantConst value, double, double) {
+  if (!value.is<bool>() && !value.is<int>()) return false;
+  field = value.as<bool>();
+  return true;
+}
+
+static bool applyConfigValue(int& field, JsonVariantConst value, double minValue, double maxValue) {
+  if (!value.is<float>()) return false;
+  // Clamped as a double so out-of-range numbers saturate instead of wrapping
+  field = (int)constrain(value.as<double>(), minValue, maxValue);
+  return true;
+}
+
+static bool applyConfigValue(float& field, JsonVariantConst value, double minValue, double maxValue) {
+  if (!value.is<float>()) return false;
+  field = value.as<float>();
+  clampConfigValue(field, minValue, maxValue);
+  return true;
+}
+
+static String configValueText(const String& value) { return value; }
+static String configValueText(bool value) { return value ? "Yes" : "No"; }
+static String configValueText(int value) { return String(value); }
+static String configValueText(float value) { return String(value); }
+
+void ESP32S3_EasyConnect::resetConfig(DeviceConfig& target) {
+#define EASYCONNECT_CONFIG_RESET(type, name, def, lo, hi, label) target.name = def;
+  EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_RESET)
+#undef EASYCONNECT_CONFIG_RESET
+}
+
+void ESP32S3_EasyConnect::writeConfigJson(const DeviceConfig& source, JsonObject out) {
+#define EASYCONNECT_CONFIG_WRITE(type, name, def, lo, hi, label) out[#name] = source.name;
+  EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_WRITE)
+#undef EASYCONNECT_CONFIG_WRITE
+}
+
+// Single pass over the object; each key is hashed once and dispatched
+// through a switch on the precomputed schema hashes. Returns fields applied.
+int ESP32S3_EasyConnect::readConfigJson(DeviceConfig& target, JsonObjectConst in) {
+  int applied = 0;
+  for (auto kv : in) {
+    const char* key = kv.key().c_str();
+    switch (configKeyHash(key)) {
+#define EASYCONNECT_CONFIG_READ(type, name, def, lo, hi, label) \
+      case configKeyHash(#name): \
+        if (strcmp(key, #name) == 0 && applyConfigValue(target.name, kv.value(), lo, hi)) applied++; \
+        break;
+      EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_READ)
+#undef EASYCONNECT_CONFIG_READ
+      default:
+        break;
+    }
+  }
+  return applied;
+}
+
+void ESP32S3_EasyConnect::clampConfig(DeviceConfig& target) {
+#define EASYCONNECT_CONFIG_CLAMP(type, name, def, lo, hi, label) clampConfigValue(target.name, lo, hi);
+  EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_CLAMP)
+#undef EASYCONNECT_CONFIG_CLAMP
+}
+
+String ESP32S3_EasyConnect::describeConfig(const DeviceConfig& source) {
+  String text;
+#define EASYCONNECT_CONFIG_DESCRIBE(type, name, def, lo, hi, label) \
+  text += "  " label ": " + configValueText(source.name) + "\r\n";
+  EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_DESCRIBE)
+#undef EASYCONNECT_CONFIG_DESCRIBE
+  return text;
+}
+
+// CRC-32 (IEEE 802.3), bitwise: config files are small and written rarely
+static uint32_t configCrc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void ESP32S3_EasyConnect::setConfigBackend(ConfigBackend backend) {
+  configBackend = backend;
+}
+
+bool ESP32S3_EasyConnect::loadConfig() {
+  if (configBackend == CONFIG_BACKEND_NVS) {
+    return loadNvsConfig();
+  }
+  return loadSlotConfig();
+}
+
+bool ESP32S3_EasyConnect::saveConfig() {
+  if (configBackend == CONFIG_BACKEND_NVS) {
+    return saveNvsConfig();
+  }
+  return saveSlotConfig();
+}
+
+bool ESP32S3_EasyConnect::loadSlotConfig() {
+  // The newest slot with a valid CRC wins; a torn write only costs that slot
+  DeviceConfig candidate;
+  uint32_t sequence = 0;
+  configSlot = -1;
+  for (int slot = 0; slot < 2; slot++) {
+    if (!LittleFS.exists(configSlots[slot])) {
+      continue;
+    }
+    if (!readConfigSlot(configSlots[slot], candidate, sequence)) {
+      configStoreStats.corruptSlots++;
+      logln("⚠️ Ignoring damaged config slot " + String(configSlots[slot]));
+      continue;
+    }
+    if (configSlot < 0 || sequence > configSequence) {
+      config = candidate;
+      configSequence = sequence;
+      configSlot = slot;
+    }
+  }
+  
+  if (configSlot < 0) {
+    return loadLegacyConfig();
+  }
+  logln("✅ Configuration loaded successfully");
+  return true;
+}
+
+bool ESP32S3_EasyConnect::readConfigSlot(const char* path, DeviceConfig& target, uint32_t& sequence) {
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return false;
+  }
+  
+  // Header line: EC1 <sequence> <crc32> <length>, followed by the JSON body
+  String header = file.readStringUntil('\n');
+  unsigned long fileSequence = 0, crc = 0, length = 0;
+  if (sscanf(header.c_str(), "EC1 %lu %lx %lu", &fileSequence, &crc, &length) != 3 ||
+      length == 0 || length > CONFIG_FILE_MAX) {
+    file.close();
+    return false;
+  }
+  
+  std::unique_ptr<char[]> body(new char[length + 1]);
+  size_t got = file.readBytes(body.get(), length);
+  file.close();
+  if (got != length || configCrc32((const uint8_t*)body.get(), length) != crc) {
+    return false;
+  }
+  body[length] = '\0';
+  
+  DynamicJsonDocument doc(CONFIG_JSON_INPUT_CAPACITY);
+  if (deserializeJson(doc, body.get(), length)) {
+    return false;
+  }
+  resetConfig(target);
+  readConfigJson(target, doc.as<JsonObjectConst>());
+  sequence = fileSequence;
+  return true;
+}
+
+bool ESP32S3_EasyConnect::loadLegacyConfig() {
+  File file = LittleFS.open(configFile, "r");
+  if (!file) {
+    logln("❌ Failed to open config file for reading");
+    return false;
+  }
+  
+  DynamicJsonDocument doc(CONFIG_JSON_INPUT_CAPACITY);
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  
+  if (error) {
+    logln("❌ Failed to parse config file");
+    return false;
+  }
+  
+  // Fields missing from the file keep their defaults
+  resetConfig(config);
+  readConfigJson(config, doc.as<JsonObjectConst>());
+  
+  // Move it into the slot format
+  markConfigDirty();
+  
+  logln("✅ Configuration loaded successfully");
+  return true;
+}
+
+bool ESP32S3_EasyConnect::saveSlotConfig() {
+  StaticJsonDocument<CONFIG_JSON_CAPACITY> doc;
+  lockConfig();
+  writeConfigJson(config, doc.to<JsonObject>());
+  unlockConfig();
+  
+  size_t length = measureJson(doc);
+  std::unique_ptr<char[]> body(new char[length + 1]);
+  serializeJson(doc, body.get(), length + 1);
+  
+  // Always overwrite the older slot so the newest good copy survives a power loss
+  int slot = (configSlot == 0) ? 1 : 0;
+  uint32_t sequence = configSequence + 1;
+  char header[48];
+  snprintf(header, sizeof(header), "EC1 %lu %08lx %lu\n", (unsigned long)sequence,
+           (unsigned long)configCrc32((const uint8_t*)body.get(), length), (unsigned long)length);
+  
+  File file = LittleFS.open(configTempFile, "w");
+  if (!file) {
+    logln("❌ Failed to open config file for writing");
+    return false;
+  }
+  size_t written = file.write((const uint8_t*)header, strlen(header));
+  written += file.write((const uint8_t*)body.get(), length);
+  file.close();
+  
+  if (written != strlen(header) + length) {
+    LittleFS.remove(configTempFile);
+    logln("❌ Failed to write config file");
+    return false;
+  }
+  if (!LittleFS.rename(configTempFile, configSlots[slot])) {
+    // Filesystems that refuse to rename over a file: the other slot still holds the previous config
+    LittleFS.remove(configSlots[slot]);
+    if (!LittleFS.rename(configTempFile, configSlots[slot])) {
+      logln("❌ Failed to commit config file");
+      return false;
+    }
+  }
+  
+  configSlot = slot;
+  configSequence = sequence;
+  configDirty = false;
+  configStoreStats.flashWrites++;
+  
+  if (LittleFS.exists(configFile)) {
+    LittleFS.remove(configFile);
+  }
+  
+  logln("✅ Configuration saved successfully");
+  return true;
+}
+
+// Typed NVS accessors used by the schema expansions below
+static void readNvsValue(Preferences& prefs, const char* key, String& field) { field = prefs.getString(key, field); }
+static void readNvsValue(Preferences& prefs, const char* key, bool& field) { field = prefs.getBool(key, field); }
+static void readNvsValue(Preferences& prefs, const char* key, int& field) { field = prefs.getInt(key, field); }
+static void readNvsValue(Preferences& prefs, const char* key, float& field) { field = prefs.getFloat(key, field); }
+
+// put*() return the bytes stored, 0 on failure (and for an empty string)
+static bool writeNvsValue(Preferences& prefs, const char* key, const String& value) { return prefs.putString(key, value) == value.length(); }
+static bool writeNvsValue(Preferences& prefs, const char* key, bool value) { return prefs.putBool(key, value) != 0; }
+static bool writeNvsValue(Preferences& prefs, const char* key, int value) { return prefs.putInt(key, value) != 0; }
+static bool writeNvsValue(Preferences& prefs, const char* key, float value) { return prefs.putFloat(key, value) != 0; }
+
+bool ESP32S3_EasyConnect::loadNvsConfig() {
+  Preferences prefs;
+  int found = 0;
+  if (prefs.begin(configNamespace, true)) {
+    // Only keys that exist are read; missing fields keep their defaults
+    resetConfig(config);
+#define EASYCONNECT_CONFIG_NVS_READ(type, name, def, lo, hi, label) \
+    static_assert(sizeof(#name) <= 16, "NVS keys are limited to 15 characters"); \
+    if (prefs.isKey(#name)) { readNvsValue(prefs, #name, config.name); found++; }
+    EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_NVS_READ)
+#undef EASYCONNECT_CONFIG_NVS_READ
+    prefs.end();
+  }
+  if (found == 0) {
+    // No config keys yet (an older firmware may have left only its
+    // fast-connect blob here): import the file-based config once, if any
+    logln("⚠️ No configuration in NVS");
+    if (loadSlotConfig()) {
+      markConfigDirty();
+      return true;
+    }
+    return false;
+  }
+  
+  persistedConfig = config;
+  persistedConfigValid = true;
+  logln("✅ Configuration loaded from NVS (" + String(found) + " fields)");
+  return found > 0;
+}
+
+bool ESP32S3_EasyConnect::saveNvsConfig() {
+  lockConfig();
+  DeviceConfig current = config;
+  unlockConfig();
+  
+  Preferences prefs;
+  if (!prefs.begin(configNamespace, false)) {
+    logln("❌ Failed to open NVS namespace for writing");
+    return false;
+  }
+  
+  // NVS writes are per key, so only fields that changed are written
+  int written = 0;
+  bool ok = true;
+#define EASYCONNECT_CONFIG_NVS_WRITE(type, name, def, lo, hi, label) \
+  if (!persistedConfigValid || !(current.name == persistedConfig.name)) { \
+    if (!writeNvsValue(prefs, #name, current.name)) ok = false; \
+    written++; \
+  }
+  EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_NVS_WRITE)
+#undef EASYCONNECT_CONFIG_NVS_WRITE
+  prefs.end();
+  
+  if (!ok) {
+    logln("❌ Failed to write configuration to NVS");
+    return false;
+  }
+  configDirty = false;
+  persistedConfig = current;
+  persistedConfigValid = true;
+  if (written > 0) {
+    configStoreStats.flashWrites++;
+  } else {
+    configStoreStats.writesAvoided++;
+  }
+  
+  logln("✅ Configuration saved to NVS (" + String(written) + " fields)");
+  return true;
+}
+
+void ESP32S3_EasyConnect::markConfigDirty() {
+  unsigned long now = millis();
+  configStoreStats.saveRequests++;
+  if (configDirty) {
+    // Folded into the flush that is already pending
+    configStoreStats.writesAvoided++;
+  } else {
+    configDirty = true;
+    configDirtySince = now;
+  }
+  armConfigFlush();
+}
+
+// Flush once changes go quiet, but no later than CONFIG_FLUSH_MAX_DELAY after the first
+void ESP32S3_EasyConnect::armConfigFlush() {
+  unsigned long dirtyFor = millis() - configDirtySince;
+  unsigned long delayMs = dirtyFor >= CONFIG_FLUSH_MAX_DELAY ? 0 : min((unsigned long)CONFIG_FLUSH_DELAY, CONFIG_FLUSH_MAX_DELAY - dirtyFor);
+  timers.cancel(configFlushTimer);
+  configFlushTimer = timers.schedule(delayMs, 0, [](void* arg) {
+    static_cast<ESP32S3_EasyConnect*>(arg)->flushConfig();
+  }, this);
+}
+
+void ESP32S3_EasyConnect::flushConfig() {
+  if (!configDirty) return;
+  
+  if (!saveConfig()) {
+    // Back off before retrying a failing filesystem
+    configDirtySince = millis();
+    armConfigFlush();
+  }
+}
+
+ConfigStoreStats ESP32S3_EasyConnect::getConfigStoreStats() {
+  return configStoreStats;
+}
+
+void ESP32S3_EasyConnect::setupWebServer() {
+  // Precompressed assets (firmware, then LittleFS manifest) first;
+  // plain files remain reachable through serveStatic
+  static const char* assetHeaders[] = {"If-None-Match", "Accept-Encoding"};
+  server.collectHeaders(assetHeaders, 2);
+  int assetCount = assetHandler.begin(LittleFS);
+  if (assetCount > 0) {
+    server.addHandler(&assetHandler);
+    logln("📦 Serving " + String(assetCount) + " precompressed dashboard assets");
+  }
+  
+  // Serve static files from LittleFS
+  server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
+  
+  // REST API endpoints
+  // Every route is timed into its /metrics histogram
+  server.on("/", HTTP_GET, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_ROOT]); handleRoot(); });
+  server.on("/api/status", HTTP_GET, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_STATUS]); handleAPIStatus(); });
+  server.on("/api/config", HTTP_GET, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_CONFIG]); handleAPIConfig(); });
+  server.on("/api/config", HTTP_POST, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_CONFIG]); handleAPIConfig(); });
+  server.on("/api/system", HTTP_POST, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_SYSTEM]); handleAPISystem(); });
+  server.on("/api/scan", HTTP_GET, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_SCAN]); handleAPIScan(); });
+  server.on("/api/command", HTTP_POST, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_COMMAND]); handleAPICommand(); });
+  server.on("/metrics", HTTP_GET, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_METRICS]); handleMetrics(); });
+#if EASYCONNECT_PROFILING
+  server.on("/api/perf", HTTP_GET, [this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_PERF]); handleAPIPerf(); });
+#endif
+  server.onNotFound([this]() { MetricTimer t(metrics.httpRoutes[HTTP_ROUTE_NOT_FOUND]); handleNotFound(); });
+}
+
+int StaticAssetHandler::begin(fs::FS& filesystem) {
+  fs = &filesystem;
+  assetCount = 0;
+  loadEmbedded();
+  loadManifest();
+  return assetCount;
+}
+
+void StaticAssetHandler::loadEmbedded() {
+#ifdef EASYCONNECT_EMBEDDED_ASSETS
+  for (size_t i = 0; i < sizeof(EMBEDDED_ASSETS) / sizeof(EMBEDDED_ASSETS[0]) && assetCount < MAX_ASSETS; i++) {
+    const EmbeddedAsset& embedded = EMBEDDED_ASSETS[i];
+    // A plain file uploaded under the same name overrides the built-in copy
+    if (fs->exists(embedded.path)) {
+      continue;
+    }
+    StaticAsset& asset = assets[assetCount++];
+    asset.path = embedded.path;
+    asset.etag = embedded.etag;
+    asset.type = embedded.contentType;
+    asset.immutable = embedded.immutable;
+    asset.data = embedded.data;
+    asset.length = embedded.length;
+  }
+#endif
+}
+
+void StaticAssetHandler::loadManifest() {
+  File manifest = fs->open("/assets.manifest", "r");
+  if (!manifest) {
+    return;
+  }
+  
+  // One line per asset: <path> "<etag>" <immutable>
+  while (manifest.available()) {
+    String line = manifest.readStringUntil('\n');
+    line.trim();
+    int first = line.indexOf(' ');
+    int last = line.lastIndexOf(' ');
+    if (first <= 0 || last <= first) {
+      continue;
+    }
+    String path = line.substring(0, first);
+    String etag = line.substring(first + 1, last);
+    
+    // Same content as the embedded copy: keep serving it from flash
+    StaticAsset* asset = find(path);
+    if (asset != nullptr && asset->etag == etag) {
+      continue;
+    }
+    if (asset == nullptr) {
+      if (assetCount >= MAX_ASSETS) {
+        continue;
+      }
+      asset = &assets[assetCount++];
+    }
+    asset->path = path;
+    asset->etag = etag;
+    asset->type = contentType(path);
+    asset->immutable = line.substring(last + 1) == "1";
+    asset->data = nullptr;
+    asset->length = 0;
+  }
+  manifest.close();
+}
+
+StaticAsset* StaticAssetHandler::find(const String& uri) {
+  const String& path = uri.endsWith("/") ? uri + "index.html" : uri;
+  for (int i = 0; i < assetCount; i++) {
+    if (assets[i].path == path) {
+      return &assets[i];
+    }
+  }
+  return nullptr;
+}
+
+const char* StaticAssetHandler::contentType(const String& path) {
+  if (path.endsWith(".html")) return "text/html";
+  if (path.endsWith(".css")) return "text/css";
+  if (path.endsWith(".js")) return "application/javascript";
+  if (path.endsWith(".json")) return "application/json";
+  if (path.endsWith(".svg")) return "image/svg+xml";
+  if (path.endsWith(".png")) return "image/png";
+  if (path.endsWith(".ico")) return "image/x-icon";
+  return "application/octet-stream";
+}
+
+bool StaticAssetHandler::canHandle(HTTPMethod method, String uri) {
+  return method == HTTP_GET && find(uri) != nullptr;
+}
+
+// Whether an Accept-Encoding value allows gzip: an explicit gzip entry
+// decides, otherwise "*"; q=0 refuses
+bool StaticAssetHandler::acceptsGzip(const String& acceptEncoding) {
+  float gzipQ = -1;
+  float anyQ = -1;
+  const char* p = acceptEncoding.c_str();
+  while (*p != '\0') {
+    while (*p == ' ' || *p == ',') p++;
+    const char* coding = p;
+    while (*p != '\0' && *p != ',' && *p != ';' && *p != ' ') p++;
+    size_t length = p - coding;
+    float q = 1;
+    while (*p != '\0' && *p != ',') {
+      if (*p == ';') {
+        p++;
+        while (*p == ' ') p++;
+        if ((*p == 'q' || *p == 'Q') && p[1] == '=') q = atof(p + 2);
+      } else {
+        p++;
+      }
+    }
+    if ((length == 4 && strncasecmp(coding, "gzip", 4) == 0) ||
+        (length == 6 && strncasecmp(coding, "x-gzip", 6) == 0)) {
+      gzipQ = q;
+    } else if (length == 1 && *coding == '*') {
+      anyQ = q;
+    }
+  }
+  return gzipQ >= 0 ? gzipQ > 0 : anyQ > 0;
+}
+
+bool StaticAssetHandler::handle(WebServer& server, HTTPMethod method, String uri) {
+  StaticAsset* asset = find(uri);
+  if (asset == nullptr) {
+    return false;
+  }
+  stats.requests++;
+  server.sendHeader("Vary", "Accept-Encoding");
+  
+  // No Accept-Encoding means any coding is fine; one that rules gzip out gets
+  // the plain file when LittleFS has it, otherwise 406
+  if (server.hasHeader("Accept-Encoding") && !acceptsGzip(server.header("Accept-Encoding"))) {
+    if (!fs->exists(asset->path)) {
+      server.send(406, "text/plain", "Asset is only available gzip-encoded");
+      return true;
+    }
+    File plain = fs->open(asset->path, "r");
+    stats.fileOpens++;
+    stats.bytesSent += server.streamFile(plain, asset->type);
+    plain.close();
+    return true;
+  }
   
-  DynamicJsonDocument doc(1024);
-  DeserializationError error = deserializeJson(doc, buf.get());
+  server.sendHeader("ETag", asset->etag);
+  server.sendHeader("Cache-Control", asset->immutable ? "public, max-age=31536000, immutable" : "no-cache");
   
-  if (error) {
-    logln("❌ Failed to parse config file");
-    return false;
+  // Revalidation: the browser already holds this exact content
+  if (server.header("If-None-Match") == asset->etag) {
+    stats.notModified++;
+    server.send(304);
+    return true;
   }
   
-  config.deviceName = doc["deviceName"] | "ESP32-S3-Device";
-  config.theme = doc["theme"] | "dark";
-  config.enableOTA = doc["enableOTA"] | true;
-  config.enableTelnet = doc["enableTelnet"] | true;
-  config.telnetPort = doc["telnetPort"] | 23;
-  config.updateInterval = doc["updateInterval"] | 5000;
-  config.customParam1 = doc["customParam1"] | "";
-  config.customParam2 = doc["customParam2"] | "";
-  config.customParam3 = doc["customParam3"] | 0;
-  config.customParam4 = doc["customParam4"] | 0.0;
+  if (asset->data != nullptr) {
+    // Straight from the firmware image, no filesystem access
+    stats.fromFlash++;
+    stats.bytesSent += asset->length;
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, asset->type, (const char*)asset->data, asset->length);
+    return true;
+  }
   
-  logln("✅ Configuration loaded successfully");
-  return true;
-}
-
-bool ESP32S3_EasyConnect::saveConfig() {
-  DynamicJsonDocument doc(1024);
-  
-  doc["deviceName"] = config.deviceName;
-  doc["theme"] = config.theme;
-  doc["enableOTA"] = config.enableOTA;
-  doc["enableTelnet"] = config.enableTelnet;
-  doc["telnetPort"] = config.telnetPort;
-  doc["updateInterval"] = config.updateInterval;
-  doc["customParam1"] = config.customParam1;
-  doc["customParam2"] = config.customParam2;
-  doc["customParam3"] = config.customParam3;
-  doc["customParam4"] = config.customParam4;
-  
-  File file = LittleFS.open(configFile, "w");
+  File file = fs->open(asset->path + ".gz", "r");
   if (!file) {
-    logln("❌ Failed to open config file for writing");
-    return false;
+    server.send(500, "text/plain", "Asset missing from filesystem");
+    return true;
   }
-  
-  serializeJson(doc, file);
+  stats.fileOpens++;
+  // streamFile adds Content-Encoding: gzip for .gz files
+  stats.bytesSent += server.streamFile(file, asset->type);
   file.close();
-  
-  logln("✅ Configuration saved successfully");
   return true;
 }
 
-void ESP32S3_EasyConnect::setupWebServer() {
-  // Serve static files from LittleFS
-  server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
-  
-  // REST API endpoints
-  server.on("/", HTTP_GET, [this]() { handleRoot(); });
-  server.on("/api/status", HTTP_GET, [this]() { handleAPIStatus(); });
-  server.on("/api/config", HTTP_GET, [this]() { handleAPIConfig(); });
-  server.on("/api/config", HTTP_POST, [this]() { handleAPIConfig(); });
-  server.on("/api/system", HTTP_POST, [this]() { handleAPISystem(); });
-  server.on("/api/scan", HTTP_GET, [this]() { handleAPIScan(); });
-  server.onNotFound([this]() { handleNotFound(); });
+std::atomic<uint32_t> ChunkedResponse::totalBytes(0);
+
+ChunkedResponse::ChunkedResponse(WebServer& server, int code, const char* contentType)
+  : server(server) {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(code, contentType, "");
+}
+
+size_t ChunkedResponse::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t ChunkedResponse::write(const uint8_t* data, size_t length) {
+  if (finished) return 0;
+  size_t written = 0;
+  while (written < length) {
+    size_t n = min(length - written, CHUNK_SIZE - used);
+    memcpy(buffer + used, data + written, n);
+    used += n;
+    written += n;
+    if (used == CHUNK_SIZE) {
+      flushChunk();
+    }
+  }
+  return written;
+}
+
+void ChunkedResponse::flushChunk() {
+  if (used == 0) return;
+  server.sendContent(buffer, used);
+  totalBytes.fetch_add(used, std::memory_order_relaxed);
+  used = 0;
+}
+
+void ChunkedResponse::end() {
+  if (finished) return;
+  flushChunk();
+  server.sendContent("");  // Zero-length chunk terminates the response
+  finished = true;
 }
 
 void ESP32S3_EasyConnect::setupWebSocket() {
-  webSocket.begin();
+  webSocketListenFd = listenSocketOpenedBy([this]() { webSocket.begin(); });
   webSocket.onEvent([this](uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
     this->webSocketEvent(num, type, payload, length);
   });
@@ -510,61 +2771,42 @@ void ESP32S3_EasyConnect::handleAPIStatus() {
   doc["system"]["telnetEnabled"] = config.enableTelnet;
   doc["system"]["telnetClients"] = getTelnetClientCount();
   
-  // Add custom data if callback is set
-  if (customDataCallback != nullptr) {
-    customDataCallback(doc);
-  }
+  // Add custom data from subscribers
+  customDataHandlers(doc);
   
-  String response;
+  ChunkedResponse response(server, 200, "application/json");
   serializeJson(doc, response);
-  server.send(200, "application/json", response);
 }
 
 void ESP32S3_EasyConnect::handleAPIConfig() {
   if (server.method() == HTTP_GET) {
-    DynamicJsonDocument doc(1024);
-    
-    doc["deviceName"] = config.deviceName;
-    doc["theme"] = config.theme;
-    doc["enableOTA"] = config.enableOTA;
-    doc["enableTelnet"] = config.enableTelnet;
-    doc["telnetPort"] = config.telnetPort;
-    doc["updateInterval"] = config.updateInterval;
-    doc["customParam1"] = config.customParam1;
-    doc["customParam2"] = config.customParam2;
-    doc["customParam3"] = config.customParam3;
-    doc["customParam4"] = config.customParam4;
+    StaticJsonDocument<CONFIG_JSON_CAPACITY> doc;
+    writeConfigJson(config, doc.to<JsonObject>());
     
-    String response;
+    ChunkedResponse response(server, 200, "application/json");
     serializeJson(doc, response);
-    server.send(200, "application/json", response);
     
   } else if (server.method() == HTTP_POST) {
     String body = server.arg("plain");
-    DynamicJsonDocument doc(1024);
+    DynamicJsonDocument doc(CONFIG_JSON_INPUT_CAPACITY);
     DeserializationError error = deserializeJson(doc, body);
     
+    if (error == DeserializationError::NoMemory) {
+      server.send(413, "application/json", "{\"error\":\"Configuration too large\"}");
+      return;
+    }
     if (error) {
       server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
       return;
     }
     
-    if (doc.containsKey("deviceName")) config.deviceName = doc["deviceName"].as<String>();
-    if (doc.containsKey("theme")) config.theme = doc["theme"].as<String>();
-    if (doc.containsKey("enableOTA")) config.enableOTA = doc["enableOTA"];
-    if (doc.containsKey("enableTelnet")) config.enableTelnet = doc["enableTelnet"];
-    if (doc.containsKey("telnetPort")) config.telnetPort = doc["telnetPort"];
-    if (doc.containsKey("updateInterval")) config.updateInterval = doc["updateInterval"];
-    if (doc.containsKey("customParam1")) config.customParam1 = doc["customParam1"].as<String>();
-    if (doc.containsKey("customParam2")) config.customParam2 = doc["customParam2"].as<String>();
-    if (doc.containsKey("customParam3")) config.customParam3 = doc["customParam3"];
-    if (doc.containsKey("customParam4")) config.customParam4 = doc["customParam4"];
+    lockConfig();
+    readConfigJson(config, doc.as<JsonObjectConst>());
+    unlockConfig();
     
-    saveConfig();
+    markConfigDirty();
     
-    if (onConfigChangedCallback != nullptr) {
-      onConfigChangedCallback();
-    }
+    notifyEvent(EVENT_CONFIG_CHANGED);
     
     server.send(200, "application/json", "{\"status\":\"Configuration updated\"}");
   }
@@ -586,22 +2828,278 @@ void ESP32S3_EasyConnect::handleAPISystem() {
   }
 }
 
+void ESP32S3_EasyConnect::handleAPICommand() {
+  String line = server.hasArg("cmd") ? server.arg("cmd") : server.arg("plain");
+  line.trim();
+  if (line.length() == 0) {
+    server.send(400, "application/json", "{\"error\":\"Missing command\"}");
+    return;
+  }
+  
+  CommandContext ctx;
+  ctx.source = COMMAND_REST;
+  ctx.client = -1;
+  if (!dispatchCommand(ctx, line)) {
+    server.send(404, "application/json", "{\"error\":\"Unknown command\"}");
+  }
+}
+
+const uint32_t LatencyHistogram::BOUNDS[LatencyHistogram::BUCKETS - 1] = {
+  100, 250, 500, 1000, 2500, 5000, 10000, 25000, 100000
+};
+
+void LatencyHistogram::record(uint32_t elapsedMicros) {
+  int bucket = 0;
+  while (bucket < BUCKETS - 1 && elapsedMicros > BOUNDS[bucket]) bucket++;
+  counts[bucket].fetch_add(1, std::memory_order_relaxed);
+  sumMicros.fetch_add(elapsedMicros, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+  for (int i = 0; i < BUCKETS; i++) {
+    counts[i].store(0, std::memory_order_relaxed);
+  }
+  sumMicros.store(0, std::memory_order_relaxed);
+}
+
+// Prometheus text exposition helpers
+static void writeMetricHeader(Print& out, const char* name, const char* type, const char* help) {
+  out.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void writeMetric(Print& out, const char* name, const char* labels, double value) {
+  out.printf("%s%s %.10g\n", name, labels, value);
+}
+
+static void writeHistogram(Print& out, const char* name, const char* label, const char* value,
+                           const LatencyHistogram& histogram) {
+  uint32_t cumulative = 0;
+  for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+    cumulative += histogram.counts[i].load(std::memory_order_relaxed);
+    if (i < LatencyHistogram::BUCKETS - 1) {
+      out.printf("%s_bucket{%s=\"%s\",le=\"%g\"} %lu\n", name, label, value,
+                 LatencyHistogram::BOUNDS[i] / 1e6, (unsigned long)cumulative);
+    } else {
+      out.printf("%s_bucket{%s=\"%s\",le=\"+Inf\"} %lu\n", name, label, value, (unsigned long)cumulative);
+    }
+  }
+  out.printf("%s_sum{%s=\"%s\"} %.6f\n", name, label, value,
+             histogram.sumMicros.load(std::memory_order_relaxed) / 1e6);
+  out.printf("%s_count{%s=\"%s\"} %lu\n", name, label, value, (unsigned long)cumulative);
+}
+
+void ESP32S3_EasyConnect::handleMetrics() {
+  static const char* routeNames[HTTP_ROUTE_COUNT] = {
+    "/", "/api/status", "/api/config", "/api/system", "/api/scan", "/api/command", "/metrics", "/api/perf", "not_found"
+  };
+  static const char* webSocketCommandNames[WS_COMMAND_COUNT] = {
+    "getStatus", "subscribe", "unsubscribe", "toggleTheme", "cmd", "custom"
+  };
+  static const char* sourceNames[3] = {"telnet", "websocket", "rest"};
+  static const char* transportNames[TRANSPORT_COUNT] = {"websocket", "telnet"};
+  
+  ChunkedResponse out(server, 200, "text/plain; version=0.0.4; charset=utf-8");
+  
+  writeMetricHeader(out, "easyconnect_http_request_duration_seconds", "histogram", "REST request handling time by route");
+  for (int i = 0; i < HTTP_ROUTE_COUNT; i++) {
+    writeHistogram(out, "easyconnect_http_request_duration_seconds", "route", routeNames[i], metrics.httpRoutes[i]);
+  }
+  writeMetricHeader(out, "easyconnect_websocket_command_duration_seconds", "histogram", "WebSocket text command handling time");
+  for (int i = 0; i < WS_COMMAND_COUNT; i++) {
+    writeHistogram(out, "easyconnect_websocket_command_duration_seconds", "command", webSocketCommandNames[i],
+                   metrics.webSocketCommands[i]);
+  }
+  writeMetricHeader(out, "easyconnect_command_duration_seconds", "histogram", "Registered command handling time by source");
+  for (int i = 0; i < 3; i++) {
+    writeHistogram(out, "easyconnect_command_duration_seconds", "source", sourceNames[i], metrics.commands[i]);
+  }
+  
+  // Per-command totals from the registry
+  char labels[64];
+  writeMetricHeader(out, "easyconnect_command_calls_total", "counter", "Registered command invocations");
+  for (int i = 0; i < commands.size(); i++) {
+    const CommandEntry& entry = commands.at(i);
+    snprintf(labels, sizeof(labels), "{command=\"%s\"}", entry.name);
+    writeMetric(out, "easyconnect_command_calls_total", labels, entry.calls);
+  }
+  writeMetricHeader(out, "easyconnect_command_seconds_total", "counter", "Time spent in registered command handlers");
+  for (int i = 0; i < commands.size(); i++) {
+    const CommandEntry& entry = commands.at(i);
+    snprintf(labels, sizeof(labels), "{command=\"%s\"}", entry.name);
+    writeMetric(out, "easyconnect_command_seconds_total", labels, entry.micros / 1e6);
+  }
+  
+  // Transport byte counters; HTTP covers streamed API responses and dashboard
+  // assets, and has no received series since WebServer hides request bytes
+  AssetStats assetStats = assetHandler.getStats();
+  writeMetricHeader(out, "easyconnect_received_bytes_total", "counter", "Bytes received by transport");
+  for (int i = 0; i < TRANSPORT_COUNT; i++) {
+    snprintf(labels, sizeof(labels), "{transport=\"%s\"}", transportNames[i]);
+    writeMetric(out, "easyconnect_received_bytes_total", labels, metrics.bytesIn[i].load(std::memory_order_relaxed));
+  }
+  writeMetricHeader(out, "easyconnect_sent_bytes_total", "counter", "Bytes sent by transport");
+  writeMetric(out, "easyconnect_sent_bytes_total", "{transport=\"http\"}",
+              (double)ChunkedResponse::totalBytes.load(std::memory_order_relaxed) + assetStats.bytesSent);
+  for (int i = 0; i < TRANSPORT_COUNT; i++) {
+    snprintf(labels, sizeof(labels), "{transport=\"%s\"}", transportNames[i]);
+    writeMetric(out, "easyconnect_sent_bytes_total", labels, metrics.bytesOut[i].load(std::memory_order_relaxed));
+  }
+  writeMetricHeader(out, "easyconnect_asset_requests_total", "counter", "Dashboard asset requests");
+  writeMetric(out, "easyconnect_asset_requests_total", "", assetStats.requests);
+  writeMetricHeader(out, "easyconnect_asset_not_modified_total", "counter", "Dashboard asset requests answered with 304");
+  writeMetric(out, "easyconnect_asset_not_modified_total", "", assetStats.notModified);
+  
+  // Connectivity
+  writeMetricHeader(out, "easyconnect_wifi_connected", "gauge", "1 while the station link is up");
+  writeMetric(out, "easyconnect_wifi_connected", "", isWiFiConnected() ? 1 : 0);
+  writeMetricHeader(out, "easyconnect_wifi_rssi_dbm", "gauge", "Station signal strength");
+  writeMetric(out, "easyconnect_wifi_rssi_dbm", "", WiFi.RSSI());
+  writeMetricHeader(out, "easyconnect_wifi_disconnects_total", "counter", "Station link losses");
+  writeMetric(out, "easyconnect_wifi_disconnects_total", "", wifiLinkStats.disconnects);
+  writeMetricHeader(out, "easyconnect_wifi_reconnect_attempts_total", "counter", "Reconnect attempts after link loss");
+  writeMetric(out, "easyconnect_wifi_reconnect_attempts_total", "", wifiLinkStats.reconnectAttempts);
+  writeMetricHeader(out, "easyconnect_wifi_roams_total", "counter", "Reconnects to a different access point");
+  writeMetric(out, "easyconnect_wifi_roams_total", "", wifiLinkStats.roams);
+  writeMetricHeader(out, "easyconnect_wifi_outage_seconds_total", "counter", "Time without a station link");
+  writeMetric(out, "easyconnect_wifi_outage_seconds_total", "", wifiLinkStats.totalOutageMillis / 1e3);
+  writeMetricHeader(out, "easyconnect_telnet_clients", "gauge", "Connected telnet sessions");
+  writeMetric(out, "easyconnect_telnet_clients", "", telnetClientCount);
+  writeMetricHeader(out, "easyconnect_websocket_clients", "gauge", "Connected WebSocket clients");
+  writeMetric(out, "easyconnect_websocket_clients", "", webSocket.connectedClients());
+  
+  // Persistence
+  writeMetricHeader(out, "easyconnect_config_save_requests_total", "counter", "Configuration save requests");
+  writeMetric(out, "easyconnect_config_save_requests_total", "", configStoreStats.saveRequests);
+  writeMetricHeader(out, "easyconnect_config_flash_writes_total", "counter", "Configuration writes that reached flash");
+  writeMetric(out, "easyconnect_config_flash_writes_total", "", configStoreStats.flashWrites);
+  
+  // Heap and loop
+  writeMetricHeader(out, "easyconnect_heap_free_bytes", "gauge", "Free internal heap");
+  writeMetric(out, "easyconnect_heap_free_bytes", "", ESP.getFreeHeap());
+  writeMetricHeader(out, "easyconnect_heap_min_free_bytes", "gauge", "Lowest free heap since boot");
+  writeMetric(out, "easyconnect_heap_min_free_bytes", "", ESP.getMinFreeHeap());
+  writeMetricHeader(out, "easyconnect_heap_max_alloc_bytes", "gauge", "Largest allocatable heap block");
+  writeMetric(out, "easyconnect_heap_max_alloc_bytes", "", ESP.getMaxAllocHeap());
+  writeMetricHeader(out, "easyconnect_psram_free_bytes", "gauge", "Free PSRAM");
+  writeMetric(out, "easyconnect_psram_free_bytes", "", ESP.getFreePsram());
+  writeMetricHeader(out, "easyconnect_loop_iterations_total", "counter", "loop() iterations since the last stats reset");
+  writeMetric(out, "easyconnect_loop_iterations_total", "", loopStats.iterations);
+  writeMetricHeader(out, "easyconnect_loop_max_seconds", "gauge", "Slowest loop() iteration since the last stats reset");
+  writeMetric(out, "easyconnect_loop_max_seconds", "", loopStats.maxLoopMicros / 1e6);
+  writeMetricHeader(out, "easyconnect_idle_seconds_total", "counter", "Time the network loop spent blocked in select()");
+  writeMetric(out, "easyconnect_idle_seconds_total", "", idleStats.idleMicros / 1e6);
+  writeMetricHeader(out, "easyconnect_idle_wakeups_total", "counter", "Idle waits by what ended them");
+  writeMetric(out, "easyconnect_idle_wakeups_total", "{reason=\"socket\"}", idleStats.socketWakeups);
+  writeMetric(out, "easyconnect_idle_wakeups_total", "{reason=\"signal\"}", idleStats.signalWakeups);
+  writeMetric(out, "easyconnect_idle_wakeups_total", "{reason=\"timeout\"}", idleStats.timeoutWakeups);
+  writeMetricHeader(out, "easyconnect_socket_wake_service_seconds", "histogram", "Socket ready during an idle wait until served");
+  writeHistogram(out, "easyconnect_socket_wake_service_seconds", "loop",
+                 networkTask != nullptr ? "network_task" : "loop", metrics.socketWake);
+  writeMetricHeader(out, "easyconnect_log_dropped_total", "counter", "Log records dropped by the log ring");
+  writeMetric(out, "easyconnect_log_dropped_total", "", logRing.dropped());
+  writeMetricHeader(out, "easyconnect_uptime_seconds", "gauge", "Time since boot");
+  writeMetric(out, "easyconnect_uptime_seconds", "", millis() / 1e3);
+}
+
 void ESP32S3_EasyConnect::handleAPIScan() {
-  int n = WiFi.scanNetworks();
-  DynamicJsonDocument doc(2048);
-  JsonArray networks = doc.createNestedArray("networks");
+  // Serve recent results straight from the cache
+  if (scanResultsValid && millis() - scanCompletedAt < scanCacheTTL) {
+    ChunkedResponse response(server, 200, "application/json");
+    response.print("{\"job\":");
+    response.print(scanJobId);
+    response.print(",\"age\":");
+    response.print(millis() - scanCompletedAt);
+    response.print(",\"networks\":");
+    streamScanResults(response);
+    response.print("}");
+    return;
+  }
   
-  for (int i = 0; i < n; ++i) {
-    JsonObject network = networks.createNestedObject();
-    network["ssid"] = WiFi.SSID(i);
-    network["rssi"] = WiFi.RSSI(i);
-    network["encryption"] = (WiFi.encryptionType(i) == WIFI_AUTH_OPEN) ? "open" : "secured";
-    network["channel"] = WiFi.channel(i);
+  // Repeated requests while a scan is running join the same job
+  if (!scanInProgress) {
+    startScan();
   }
   
-  String response;
-  serializeJson(doc, response);
-  server.send(200, "application/json", response);
+  if (!scanInProgress) {
+    server.send(503, "application/json", "{\"error\":\"Scan could not be started\"}");
+    return;
+  }
+  server.send(202, "application/json", "{\"status\":\"scanning\",\"job\":" + String(scanJobId) + "}");
+}
+
+void ESP32S3_EasyConnect::startScan() {
+  if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+    logln("❌ WiFi scan could not be started");
+    return;
+  }
+  scanInProgress = true;
+  scanJobId++;
+}
+
+void ESP32S3_EasyConnect::pollScan() {
+  int n = WiFi.scanComplete();
+  if (n == WIFI_SCAN_RUNNING) return;
+  
+  scanInProgress = false;
+  if (n < 0) {
+    logln("❌ WiFi scan failed");
+    String message = "{\"type\":\"scanResult\",\"job\":" + String(scanJobId) + ",\"error\":\"Scan failed\"}";
+    webSocketPublish(topicScan, message.c_str(), message.length());
+    return;
+  }
+  
+  scanResultCount = min(n, (int)MAX_SCAN_RESULTS);
+  for (int i = 0; i < scanResultCount; ++i) {
+    strlcpy(scanResults[i].ssid, WiFi.SSID(i).c_str(), sizeof(scanResults[i].ssid));
+    memcpy(scanResults[i].bssid, WiFi.BSSID(i), sizeof(scanResults[i].bssid));
+    scanResults[i].rssi = WiFi.RSSI(i);
+    scanResults[i].channel = WiFi.channel(i);
+    scanResults[i].open = (WiFi.encryptionType(i) == WIFI_AUTH_OPEN);
+  }
+  WiFi.scanDelete();
+  scanResultsValid = true;
+  scanCompletedAt = millis();
+  
+  // Push the results to every dashboard (capacity sized for this result set)
+  DynamicJsonDocument doc(JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(scanResultCount) +
+                          scanResultCount * (JSON_OBJECT_SIZE(4) + sizeof(scanResults[0].ssid)));
+  doc["type"] = "scanResult";
+  doc["job"] = scanJobId;
+  serializeScanResults(doc.createNestedArray("networks"));
+  
+  String message;
+  serializeJson(doc, message);
+  webSocketPublish(topicScan, message.c_str(), message.length());
+}
+
+void ESP32S3_EasyConnect::serializeScanResults(JsonArray networks) {
+  for (int i = 0; i < scanResultCount; ++i) {
+    JsonObject network = networks.createNestedObject();
+    network["ssid"] = scanResults[i].ssid;
+    network["rssi"] = scanResults[i].rssi;
+    network["encryption"] = scanResults[i].open ? "open" : "secured";
+    network["channel"] = scanResults[i].channel;
+  }
+}
+
+// Writes the networks array one element at a time, so no document ever
+// holds the whole list
+void ESP32S3_EasyConnect::streamScanResults(Print& out) {
+  out.print("[");
+  for (int i = 0; i < scanResultCount; ++i) {
+    StaticJsonDocument<JSON_OBJECT_SIZE(4)> network;
+    network["ssid"] = (const char*)scanResults[i].ssid;
+    network["rssi"] = scanResults[i].rssi;
+    network["encryption"] = scanResults[i].open ? "open" : "secured";
+    network["channel"] = scanResults[i].channel;
+    if (i > 0) out.print(",");
+    serializeJson(network, out);
+  }
+  out.print("]");
+}
+
+void ESP32S3_EasyConnect::setScanCacheTTL(unsigned long ttlMs) {
+  scanCacheTTL = ttlMs;
 }
 
 void ESP32S3_EasyConnect::handleNotFound() {
@@ -609,66 +3107,441 @@ void ESP32S3_EasyConnect::handleNotFound() {
 }
 
 void ESP32S3_EasyConnect::webSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  // Payload of every received frame: text, binary, fragments, ping and pong
+  if (type != WStype_CONNECTED && type != WStype_DISCONNECTED && type != WStype_ERROR) {
+    metrics.bytesIn[TRANSPORT_WEBSOCKET].fetch_add(length, std::memory_order_relaxed);
+  }
+  
   switch (type) {
     case WStype_DISCONNECTED:
       logf("[%u] WebSocket Disconnected!\n", num);
+      if (num < WEBSOCKETS_SERVER_CLIENT_MAX) {
+        memset(&webSocketSubs[num], 0, sizeof(webSocketSubs[num]));
+      }
       break;
     case WStype_CONNECTED:
       {
         IPAddress ip = webSocket.remoteIP(num);
         logf("[%u] WebSocket Connected from %d.%d.%d.%d\n", num, ip[0], ip[1], ip[2], ip[3]);
-        sendDeviceStatus();
+        if (num < WEBSOCKETS_SERVER_CLIENT_MAX) {
+          memset(&webSocketSubs[num], 0, sizeof(webSocketSubs[num]));
+        }
+        sendStatusSnapshot(num);
       }
       break;
     case WStype_TEXT:
       {
         String message = String((char*)payload);
         logf("[%u] WebSocket Received: %s\n", num, message.c_str());
+        unsigned long started = micros();
+        WebSocketCommandKind kind = WS_COMMAND_CUSTOM;
         
         // Handle WebSocket commands
+        // Requests are answered to the requesting client only;
+        // broadcasts are reserved for state changes
         if (message == "getStatus") {
-          sendDeviceStatus();
+          kind = WS_COMMAND_GET_STATUS;
+          sendStatusSnapshot(num);
+        } else if (message.startsWith("subscribe:")) {
+          kind = WS_COMMAND_SUBSCRIBE;
+          const char* pattern = message.c_str() + 10;
+          sendSubscriptionAck(num, "subscribed", pattern, subscribeClient(num, pattern));
+        } else if (message.startsWith("unsubscribe:")) {
+          kind = WS_COMMAND_UNSUBSCRIBE;
+          const char* pattern = message.c_str() + 12;
+          sendSubscriptionAck(num, "unsubscribed", pattern, unsubscribeClient(num, pattern));
         } else if (message == "toggleTheme") {
+          kind = WS_COMMAND_TOGGLE_THEME;
+          lockConfig();
           config.theme = (config.theme == "dark") ? "light" : "dark";
-          saveConfig();
+          unlockConfig();
+          markConfigDirty();
           sendDeviceStatus();
-        } else {
-          // Pass to custom callback
-          if (webSocketCommandCallback != nullptr) {
-            webSocketCommandCallback(message, num);
+        } else if (message.startsWith("cmd:")) {
+          // Command line, answered with a commandResult frame
+          kind = WS_COMMAND_REGISTRY;
+          CommandContext ctx;
+          ctx.source = COMMAND_WEBSOCKET;
+          ctx.client = num;
+          String line = message.substring(4);
+          line.trim();
+          if (!dispatchCommand(ctx, line)) {
+            String reply = "{\"type\":\"commandResult\",\"ok\":false,\"output\":\"Unknown command\"}";
+            webSocketSend(num, reply.c_str(), reply.length());
           }
+        } else {
+          // Pass to custom subscribers
+          webSocketCommandHandlers(message, num);
         }
+        metrics.webSocketCommands[kind].record(micros() - started);
       }
       break;
   }
 }
 
+// Broadcast only the status fields that changed since the last frame
 void ESP32S3_EasyConnect::sendDeviceStatus() {
+  publishStatusDelta(-1);
+}
+
+// Publish the fields that changed since the last delta, to every subscriber
+// but skipClient
+void ESP32S3_EasyConnect::publishStatusDelta(int skipClient) {
+  bool first = !statusModelValid;
+  StatusModel& m = statusModel;
   DynamicJsonDocument doc(512);
+  bool changed = false;
+  
+  bool wifiConnected = isWiFiConnected();
+  if (first || wifiConnected != m.wifiConnected) {
+    m.wifiConnected = wifiConnected;
+    doc["wifi"]["connected"] = wifiConnected;
+    changed = true;
+  }
+  String ssid = WiFi.SSID();
+  if (first || ssid != m.ssid) {
+    m.ssid = ssid;
+    doc["wifi"]["ssid"] = ssid;
+    changed = true;
+  }
+  int32_t rssi = WiFi.RSSI();
+  if (first || abs(rssi - m.rssi) >= STATUS_RSSI_DEADBAND) {
+    m.rssi = rssi;
+    doc["wifi"]["rssi"] = rssi;
+    changed = true;
+  }
+  String ip = WiFi.localIP().toString();
+  if (first || ip != m.ip) {
+    m.ip = ip;
+    doc["wifi"]["ip"] = ip;
+    changed = true;
+  }
+  uint32_t freeHeap = ESP.getFreeHeap();
+  if (first || (freeHeap > m.freeHeap ? freeHeap - m.freeHeap : m.freeHeap - freeHeap) >= STATUS_HEAP_DEADBAND) {
+    m.freeHeap = freeHeap;
+    doc["system"]["freeHeap"] = freeHeap;
+    changed = true;
+  }
+  lockConfig();
+  if (first || config.theme != m.theme) {
+    m.theme = config.theme;
+    doc["config"]["theme"] = m.theme;
+    changed = true;
+  }
+  if (first || config.deviceName != m.deviceName) {
+    m.deviceName = config.deviceName;
+    doc["config"]["deviceName"] = m.deviceName;
+    changed = true;
+  }
+  bool telnetEnabledNow = config.enableTelnet;
+  unlockConfig();
+  if (first || telnetEnabledNow != m.telnetEnabled) {
+    m.telnetEnabled = telnetEnabledNow;
+    doc["telnet"]["enabled"] = telnetEnabledNow;
+    changed = true;
+  }
+  int telnetClientCount = getTelnetClientCount();
+  if (first || telnetClientCount != m.telnetClients) {
+    m.telnetClients = telnetClientCount;
+    doc["telnet"]["clients"] = telnetClientCount;
+    changed = true;
+  }
+  statusModelValid = true;
+  
+  if (!changed) {
+    statusStats.ticksSuppressed++;
+    return;
+  }
   
+  // Uptime is only sent in snapshots; clients extrapolate it locally
+  m.sequence++;
   doc["type"] = "status";
-  doc["wifi"]["connected"] = isWiFiConnected();
-  doc["wifi"]["ssid"] = WiFi.SSID();
-  doc["wifi"]["rssi"] = WiFi.RSSI();
-  doc["wifi"]["ip"] = WiFi.localIP().toString();
-  doc["system"]["freeHeap"] = ESP.getFreeHeap();
+  doc["seq"] = m.sequence;
+  
+  String jsonString;
+  serializeJson(doc, jsonString);
+  uint32_t recipients = webSocketPublish(topicStatus, jsonString.c_str(), jsonString.length(), false, skipClient);
+  statusStats.deltasSent++;
+  statusStats.bytesSent += jsonString.length() * recipients;
+}
+
+// Send the complete status to one client (or all when clientNum < 0)
+void ESP32S3_EasyConnect::sendStatusSnapshot(int clientNum) {
+  // Bring the baseline up to date first so the snapshot matches the
+  // state every other client has reached through deltas; the requester
+  // gets the snapshot instead, since a delta first would look like a gap
+  publishStatusDelta(clientNum);
+  const StatusModel& m = statusModel;
+  
+  DynamicJsonDocument doc(512);
+  doc["type"] = "status";
+  doc["seq"] = m.sequence;
+  doc["full"] = true;
+  doc["wifi"]["connected"] = m.wifiConnected;
+  doc["wifi"]["ssid"] = m.ssid;
+  doc["wifi"]["rssi"] = m.rssi;
+  doc["wifi"]["ip"] = m.ip;
+  doc["system"]["freeHeap"] = m.freeHeap;
   doc["system"]["uptime"] = deviceUptime;
-  doc["config"]["theme"] = config.theme;
-  doc["config"]["deviceName"] = config.deviceName;
-  doc["telnet"]["enabled"] = config.enableTelnet;
-  doc["telnet"]["clients"] = getTelnetClientCount();
+  doc["config"]["theme"] = m.theme;
+  doc["config"]["deviceName"] = m.deviceName;
+  doc["telnet"]["enabled"] = m.telnetEnabled;
+  doc["telnet"]["clients"] = m.telnetClients;
   
   String jsonString;
   serializeJson(doc, jsonString);
-  webSocket.broadcastTXT(jsonString);
+  if (clientNum < 0) {
+    uint32_t recipients = webSocketPublish(topicStatus, jsonString.c_str(), jsonString.length());
+    statusStats.bytesSent += jsonString.length() * recipients;
+  } else {
+    webSocketSend((uint8_t)clientNum, jsonString.c_str(), jsonString.length());
+    statusStats.bytesSent += jsonString.length();
+  }
+  statusStats.snapshotsSent++;
+}
+
+StatusStreamStats ESP32S3_EasyConnect::getStatusStreamStats() {
+  return statusStats;
 }
 
 void ESP32S3_EasyConnect::broadcastWebSocket(String message) {
-  webSocket.broadcastTXT(message);
+  publishWebSocket("broadcast", message);
+}
+
+void ESP32S3_EasyConnect::publishWebSocket(const char* topic, String message) {
+  if (!onNetworkTask()) {
+    // Topic registry is owned by the network task; resolve it there
+    handOff(NetworkMessage::WEBSOCKET, message.c_str(), message.length(), 0, topic);
+    return;
+  }
+  webSocketPublish(resolveTopic(topic), message.c_str(), message.length());
+}
+
+int ESP32S3_EasyConnect::resolveTopic(const char* topic) {
+  for (int t = 0; t < webSocketTopicCount; t++) {
+    if (strcmp(webSocketTopics[t], topic) == 0) return t;
+  }
+  if (webSocketTopicCount >= MAX_WS_TOPICS || strlen(topic) >= WebSocketSubscription::NAME_SIZE) {
+    return -1;
+  }
+  
+  // Register the topic and apply stored wildcard subscriptions to it
+  int index = webSocketTopicCount++;
+  strcpy(webSocketTopics[index], topic);
+  for (int c = 0; c < WEBSOCKETS_SERVER_CLIENT_MAX; c++) {
+    WebSocketSubscription& sub = webSocketSubs[c];
+    for (int p = 0; p < sub.patternCount; p++) {
+      if (topicMatches(sub.patterns[p], topic)) {
+        sub.topicMask |= (1UL << index);
+        break;
+      }
+    }
+  }
+  return index;
+}
+
+// Patterns: exact name, "prefix*" or "*"
+bool ESP32S3_EasyConnect::topicMatches(const char* pattern, const char* topic) {
+  size_t len = strlen(pattern);
+  if (len > 0 && pattern[len - 1] == '*') {
+    return strncmp(pattern, topic, len - 1) == 0;
+  }
+  return strcmp(pattern, topic) == 0;
+}
+
+// Send a frame to every client subscribed to the topic except skipClient;
+// returns recipients
+uint32_t ESP32S3_EasyConnect::webSocketPublish(int topicIndex, const char* data, size_t length, bool binary, int skipClient) {
+  uint32_t bit = (topicIndex >= 0) ? (1UL << topicIndex) : 0;
+  uint8_t recipients[WEBSOCKETS_SERVER_CLIENT_MAX];
+  uint32_t count = 0;
+  uint32_t connected = 0;
+  
+  for (int c = 0; c < WEBSOCKETS_SERVER_CLIENT_MAX; c++) {
+    if (!webSocket.clientIsConnected(c)) continue;
+    connected++;
+    if (c == skipClient) continue;
+    const WebSocketSubscription& sub = webSocketSubs[c];
+    // Unregistered topics (registry full) only reach clients that never subscribed
+    if (!sub.active || (sub.topicMask & bit)) {
+      recipients[count++] = c;
+    }
+  }
+  
+  // One broadcast when everyone wants it, otherwise targeted sends
+  if (count > 0 && count == connected) {
+    webSocketBroadcast(data, length, binary);
+  } else {
+    for (uint32_t r = 0; r < count; r++) {
+      webSocketSend(recipients[r], data, length, binary);
+    }
+  }
+  return count;
+}
+
+// False when the pattern does not fit or the client has no free pattern slot
+bool ESP32S3_EasyConnect::subscribeClient(uint8_t clientNum, const char* pattern) {
+  if (clientNum >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  WebSocketSubscription& sub = webSocketSubs[clientNum];
+  size_t len = strlen(pattern);
+  if (len == 0 || len >= WebSocketSubscription::NAME_SIZE) return false;
+  
+  if (!sub.active) {
+    sub.active = true;
+    sub.topicMask = 0;
+    sub.patternCount = 0;
+  }
+  for (int p = 0; p < sub.patternCount; p++) {
+    if (strcmp(sub.patterns[p], pattern) == 0) return true;
+  }
+  if (sub.patternCount >= WebSocketSubscription::MAX_PATTERNS) return false;
+  
+  strcpy(sub.patterns[sub.patternCount++], pattern);
+  for (int t = 0; t < webSocketTopicCount; t++) {
+    if (topicMatches(pattern, webSocketTopics[t])) {
+      sub.topicMask |= (1UL << t);
+    }
+  }
+  return true;
+}
+
+// False when the pattern was not subscribed
+bool ESP32S3_EasyConnect::unsubscribeClient(uint8_t clientNum, const char* pattern) {
+  if (clientNum >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  WebSocketSubscription& sub = webSocketSubs[clientNum];
+  if (!sub.active) return false;
+  
+  int index = -1;
+  for (int p = 0; p < sub.patternCount && index < 0; p++) {
+    if (strcmp(sub.patterns[p], pattern) == 0) index = p;
+  }
+  if (index < 0) return false;
+  sub.patternCount--;
+  memmove(sub.patterns[index], sub.patterns[index + 1], (sub.patternCount - index) * WebSocketSubscription::NAME_SIZE);
+  
+  // Topics matched by the removed pattern may still be covered by another
+  sub.topicMask = 0;
+  for (int t = 0; t < webSocketTopicCount; t++) {
+    for (int p = 0; p < sub.patternCount; p++) {
+      if (topicMatches(sub.patterns[p], webSocketTopics[t])) {
+        sub.topicMask |= (1UL << t);
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+// The pattern is client input, so let ArduinoJson escape it; overlong
+// patterns are not echoed back
+void ESP32S3_EasyConnect::sendSubscriptionAck(uint8_t clientNum, const char* type, const char* pattern, bool ok) {
+  StaticJsonDocument<JSON_OBJECT_SIZE(3)> doc;
+  doc["type"] = type;
+  if (strlen(pattern) < WebSocketSubscription::NAME_SIZE) {
+    doc["topic"] = pattern;
+  }
+  doc["ok"] = ok;
+  char ack[96 + 6 * WebSocketSubscription::NAME_SIZE];
+  size_t length = serializeJson(doc, ack, sizeof(ack));
+  webSocketSend(clientNum, ack, length);
+}
+
+void ESP32S3_EasyConnect::sendWebSocket(uint8_t clientNum, String message) {
+  if (!onNetworkTask()) {
+    handOff(NetworkMessage::WEBSOCKET_CLIENT, message.c_str(), message.length(), clientNum);
+    return;
+  }
+  webSocketSend(clientNum, message.c_str(), message.length());
+}
+
+WebSocketStats ESP32S3_EasyConnect::getWebSocketStats() {
+  return webSocketStats;
+}
+
+void ESP32S3_EasyConnect::webSocketBroadcast(const char* data, size_t length, bool binary) {
+  if (binary) {
+    webSocket.broadcastBIN((const uint8_t*)data, length);
+  } else {
+    webSocket.broadcastTXT((const uint8_t*)data, length);
+  }
+  uint8_t recipients = webSocket.connectedClients();
+  webSocketStats.broadcastFrames++;
+  webSocketStats.broadcastDeliveries += recipients;
+  metrics.bytesOut[TRANSPORT_WEBSOCKET].fetch_add(length * recipients, std::memory_order_relaxed);
+}
+
+void ESP32S3_EasyConnect::webSocketSend(uint8_t clientNum, const char* data, size_t length, bool binary) {
+  if (binary) {
+    webSocket.sendBIN(clientNum, (const uint8_t*)data, length);
+  } else {
+    webSocket.sendTXT(clientNum, (const uint8_t*)data, length);
+  }
+  webSocketStats.unicastFrames++;
+  metrics.bytesOut[TRANSPORT_WEBSOCKET].fetch_add(length, std::memory_order_relaxed);
+}
+
+bool ESP32S3_EasyConnect::publishTelemetry(const char* topic, std::initializer_list<TelemetryField> fields) {
+  return publishTelemetry(topic, fields.begin(), fields.size());
+}
+
+bool ESP32S3_EasyConnect::publishTelemetry(const char* topic, const TelemetryField* fields, size_t count) {
+  if (count > MAX_TELEMETRY_FIELDS) return false;
+  
+  // Names and topic are stored as pointers: no copies, no heap
+  StaticJsonDocument<JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(MAX_TELEMETRY_FIELDS)> doc;
+  doc["t"] = topic;
+  doc["ts"] = (uint32_t)millis();
+  JsonObject values = doc.createNestedObject("v");
+  for (size_t i = 0; i < count; i++) {
+    values[fields[i].name] = fields[i].value;
+  }
+  
+  uint8_t frame[TELEMETRY_FRAME_SIZE];
+  unsigned long start = micros();
+  size_t length = serializeMsgPack(doc, frame, sizeof(frame));
+  telemetryCounters.encodeMicros.fetch_add(micros() - start, std::memory_order_relaxed);
+  if (length == 0 || length >= sizeof(frame)) return false;
+  
+  if (telemetryComparison) {
+    char json[TELEMETRY_FRAME_SIZE * 2];
+    start = micros();
+    telemetryCounters.jsonBytes.fetch_add(serializeJson(doc, json, sizeof(json)), std::memory_order_relaxed);
+    telemetryCounters.jsonMicros.fetch_add(micros() - start, std::memory_order_relaxed);
+  }
+  telemetryCounters.frames.fetch_add(1, std::memory_order_relaxed);
+  telemetryCounters.bytes.fetch_add(length, std::memory_order_relaxed);
+  
+  if (!onNetworkTask()) {
+    return handOff(NetworkMessage::WEBSOCKET, (const char*)frame, length, 0, topic, true);
+  }
+  webSocketPublish(resolveTopic(topic), (const char*)frame, length, true);
+  return true;
+}
+
+void ESP32S3_EasyConnect::setTelemetryComparison(bool enabled) {
+  telemetryComparison = enabled;
+}
+
+AssetStats ESP32S3_EasyConnect::getAssetStats() {
+  return assetHandler.getStats();
+}
+
+TelemetryStats ESP32S3_EasyConnect::getTelemetryStats() {
+  TelemetryStats stats;
+  stats.frames = telemetryCounters.frames.load(std::memory_order_relaxed);
+  stats.bytes = telemetryCounters.bytes.load(std::memory_order_relaxed);
+  stats.encodeMicros = telemetryCounters.encodeMicros.load(std::memory_order_relaxed);
+  stats.jsonBytes = telemetryCounters.jsonBytes.load(std::memory_order_relaxed);
+  stats.jsonMicros = telemetryCounters.jsonMicros.load(std::memory_order_relaxed);
+  return stats;
 }
 
 void ESP32S3_EasyConnect::restartDevice() {
+  if (configDirty) {
+    saveConfig();
+  }
   logln("🔄 Restarting device...");
+  flushLog();
   delay(1000);
   ESP.restart();
 }
@@ -679,10 +3552,30 @@ void ESP32S3_EasyConnect::factoryReset() {
   // Clear WiFi credentials
   wifiManager.resetSettings();
   
-  // Delete config file
+  // Delete config files
+  configDirty = false;
   LittleFS.remove(configFile);
+  LittleFS.remove(configSlots[0]);
+  LittleFS.remove(configSlots[1]);
+  LittleFS.remove(configTempFile);
+  
+  // Clear the NVS backend's keys
+  Preferences prefs;
+  if (prefs.begin(configNamespace, false)) {
+    prefs.clear();
+    prefs.end();
+  }
+  persistedConfigValid = false;
+  
+  // Forget the cached access point along with the credentials
+  rtcFastConnectCache.magic = 0;
+  if (prefs.begin(fastConnectNamespace, false)) {
+    prefs.clear();
+    prefs.end();
+  }
   
   // Disconnect all telnet clients
+  flushLog();
   disconnectTelnetClients();
   
   delay(1000);
@@ -694,46 +3587,20 @@ bool ESP32S3_EasyConnect::isWiFiConnected() {
 }
 
 // Callback setters
-void ESP32S3_EasyConnect::onConnected(void (*callback)()) {
-  onConnectedCallback = callback;
-}
-
-void ESP32S3_EasyConnect::onDisconnected(void (*callback)()) {
-  onDisconnectedCallback = callback;
-}
-
-void ESP32S3_EasyConnect::onConfigChanged(void (*callback)()) {
-  onConfigChangedCallback = callback;
-}
-
-void ESP32S3_EasyConnect::setCustomDataCallback(void (*callback)(JsonDocument&)) {
-  customDataCallback = callback;
-}
-
-void ESP32S3_EasyConnect::onTelnetCommand(void (*callback)(String, WiFiClient&)) {
-  telnetCommandCallback = callback;
-}
-
-void ESP32S3_EasyConnect::onWebSocketCommand(void (*callback)(String, uint8_t)) {
-  webSocketCommandCallback = callback;
+bool ESP32S3_EasyConnect::unsubscribe(SubscriptionId id) {
+  return connectedHandlers.remove(id) || disconnectedHandlers.remove(id) ||
+         configChangedHandlers.remove(id) || customDataHandlers.remove(id) ||
+         telnetCommandHandlers.remove(id) || webSocketCommandHandlers.remove(id);
 }
 
 int ESP32S3_EasyConnect::getTelnetClientCount() {
-  int count = 0;
-  for (int i = 0; i < MAX_TELNET_CLIENTS; i++) {
-    if (telnetClients[i].connected && telnetClients[i].client.connected()) {
-      count++;
-    }
-  }
-  return count;
+  return telnetClientCount;
 }
 
 void ESP32S3_EasyConnect::disconnectTelnetClients() {
-  for (int i = 0; i < MAX_TELNET_CLIENTS; i++) {
+  for (int i = 0; i < telnetSlots; i++) {
     if (telnetClients[i].connected) {
-      telnetClients[i].client.print("🔌 Server shutting down for maintenance. Goodbye!\r\n");
-      telnetClients[i].client.stop();
-      telnetClients[i].connected = false;
+      closeTelnetClient(i, "🔌 Server shutting down for maintenance. Goodbye!\r\n");
     }
   }
 }
@@ -746,8 +3613,9 @@ void ESP32S3_EasyConnect::printDebugInfo() {
   log("Free Heap: "); logln(String(ESP.getFreeHeap()) + " bytes");
   log("Theme: "); logln(config.theme);
   log("Telnet Enabled: "); logln(config.enableTelnet ? "Yes" : "No");
-  log("Telnet Clients: "); logln(String(getTelnetClientCount()) + "/" + String(MAX_TELNET_CLIENTS));
+  log("Telnet Clients: "); logln(String(getTelnetClientCount()) + "/" + String(telnetMaxClients));
   log("Uptime: "); logln(String(deviceUptime / 1000) + " seconds");
+  log("Loop Rate: "); logln(String(loopStats.iterationsPerSecond) + " loops/s (max " + String(loopStats.maxLoopMicros) + " us)");
   logln("====================================\n");
 }
 
@@ -759,11 +3627,124 @@ unsigned long ESP32S3_EasyConnect::getUptime() {
   return deviceUptime;
 }
 
+LoopStats ESP32S3_EasyConnect::getLoopStats() {
+  return loopStats;
+}
+
+void ESP32S3_EasyConnect::resetLoopStats() {
+  loopStats.iterations = 0;
+  loopStats.iterationsPerSecond = 0;
+  loopStats.lastLoopMicros = 0;
+  loopStats.maxLoopMicros = 0;
+  loopStats.minFreeHeap = ESP.getFreeHeap();
+  loopStats.heapChurn = 0;
+  lastFreeHeap = loopStats.minFreeHeap;
+  loopStatsWindowStart = micros();
+  loopStatsWindowCount = 0;
+  memset(&idleStats, 0, sizeof(idleStats));
+  idleStatsSince = millis();
+}
+
+#if EASYCONNECT_PROFILING
+void PerfHistogram::record(uint32_t elapsedMicros) {
+  int bucket = elapsedMicros == 0 ? 0 : 32 - __builtin_clz(elapsedMicros);
+  if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+  counts[bucket]++;
+  samples++;
+  totalMicros += elapsedMicros;
+  if (elapsedMicros > maxMicros) maxMicros = elapsedMicros;
+}
+
+uint32_t PerfHistogram::percentile(uint8_t percent) const {
+  if (samples == 0) return 0;
+  uint32_t target = ((uint64_t)samples * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < BUCKETS - 1; i++) {
+    seen += counts[i];
+    if (seen >= target) {
+      return min((uint32_t)1 << i, maxMicros);
+    }
+  }
+  return maxMicros;
+}
+
+uint32_t ESP32S3_EasyConnect::recordPerfStage(PerfStage stage, uint32_t startCycles) {
+  uint32_t now = ESP.getCycleCount();
+  loopProfile.stages[stage].record((now - startCycles) / perfCyclesPerMicro);
+  // Exclude the bookkeeping itself from the next stage
+  return ESP.getCycleCount();
+}
+
+void ESP32S3_EasyConnect::resetLoopProfile() {
+  memset(&loopProfile, 0, sizeof(loopProfile));
+  perfCyclesPerMicro = max((uint32_t)1, (uint32_t)ESP.getCpuFreqMHz());
+  loopProfile.lastStartCycles = ESP.getCycleCount();
+}
+
+String ESP32S3_EasyConnect::describeLoopProfile() {
+  static const char* stageNames[PERF_STAGE_COUNT] = {
+    "outbound", "http", "websocket", "ota", "log", "telnet", "wifi", "scan", "timers"
+  };
+  char line[96];
+  String result = "Loop Profile (" + String(loopProfile.period.samples) + " loops, us):\r\n";
+  snprintf(line, sizeof(line), "  %-10s %8s %8s %8s %8s\r\n", "Stage", "p50", "p99", "max", "avg");
+  result += line;
+  for (int i = 0; i <= PERF_STAGE_COUNT; i++) {
+    const PerfHistogram& h = i < PERF_STAGE_COUNT ? loopProfile.stages[i] : loopProfile.period;
+    const char* name = i < PERF_STAGE_COUNT ? stageNames[i] : "period";
+    snprintf(line, sizeof(line), "  %-10s %8lu %8lu %8lu %8lu\r\n", name,
+             (unsigned long)h.percentile(50), (unsigned long)h.percentile(99), (unsigned long)h.maxMicros,
+             (unsigned long)(h.samples > 0 ? h.totalMicros / h.samples : 0));
+    result += line;
+  }
+  uint32_t jitter = loopProfile.period.percentile(99) - loopProfile.period.percentile(50);
+  result += "  Period jitter (p99 - p50): " + String(jitter) + " us\r\n";
+  return result;
+}
+
+void ESP32S3_EasyConnect::handleAPIPerf() {
+  static const char* stageNames[PERF_STAGE_COUNT] = {
+    "outbound", "http", "websocket", "ota", "log", "telnet", "wifi", "scan", "timers"
+  };
+  StaticJsonDocument<JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(PERF_STAGE_COUNT) +
+                     (PERF_STAGE_COUNT + 1) * JSON_OBJECT_SIZE(4)> doc;
+  doc["loops"] = loopProfile.period.samples;
+  JsonObject stages = doc.createNestedObject("stages");
+  for (int i = 0; i <= PERF_STAGE_COUNT; i++) {
+    const PerfHistogram& h = i < PERF_STAGE_COUNT ? loopProfile.stages[i] : loopProfile.period;
+    JsonObject entry = i < PERF_STAGE_COUNT ? stages.createNestedObject(stageNames[i]) : doc.createNestedObject("period");
+    entry["p50"] = h.percentile(50);
+    entry["p99"] = h.percentile(99);
+    entry["max"] = h.maxMicros;
+    entry["avg"] = h.samples > 0 ? (uint32_t)(h.totalMicros / h.samples) : 0;
+  }
+  
+  ChunkedResponse out(server, 200, "application/json");
+  serializeJson(doc, out);
+}
+#endif
+
 DeviceConfig ESP32S3_EasyConnect::getConfig() {
-  return config;
+  lockConfig();
+  DeviceConfig copy = pendingConfigSet ? pendingConfig : config;
+  unlockConfig();
+  return copy;
 }
 
 void ESP32S3_EasyConnect::setConfig(const DeviceConfig& newConfig) {
-  config = newConfig;
-  saveConfig();
+  DeviceConfig clamped = newConfig;
+  clampConfig(clamped);
+  if (!onNetworkTask()) {
+    // Applied and saved by the network task on its next iteration
+    lockConfig();
+    pendingConfig = clamped;
+    pendingConfigSet = true;
+    unlockConfig();
+    wakeNetwork();
+    return;
+  }
+  lockConfig();
+  config = clamped;
+  unlockConfig();
+  markConfigDirty();
 }
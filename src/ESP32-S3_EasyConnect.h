@@ -15,71 +15,1101 @@
 #include <ArduinoJson.h>
 #include <WebSocketsServer.h>
 #include <LittleFS.h>
+#include <Preferences.h>
+#include <atomic>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <float.h>
+#include <limits.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+// Per-stage loop profiler (perf command, /api/perf); build with
+// -D EASYCONNECT_PROFILING=0 to compile it out entirely
+#ifndef EASYCONNECT_PROFILING
+#define EASYCONNECT_PROFILING 1
+#endif
+
+// DeviceConfig schema, one line per field: X(type, name, default, min, max, label)
+// Numbers are clamped to [min, max]; for strings max is the longest accepted length.
+// The struct, defaults, config file, /api/config and the telnet listing all use it.
+#define EASYCONNECT_CONFIG_FIELDS(X) \
+  X(String, deviceName,     "ESP32-S3-Device", 0,        32,      "Device Name") \
+  X(String, theme,          "dark",            0,        10,      "Theme") \
+  X(bool,   enableOTA,      true,              0,        1,       "OTA Enabled") \
+  X(bool,   enableTelnet,   true,              0,        1,       "Telnet Enabled") \
+  X(int,    telnetPort,     23,                1,        65535,   "Telnet Port") \
+  X(int,    updateInterval, 5000,              100,      3600000, "Update Interval (ms)") \
+  X(String, customParam1,   "",                0,        64,      "Custom1") \
+  X(String, customParam2,   "",                0,        64,      "Custom2") \
+  X(int,    customParam3,   0,                 INT_MIN,  INT_MAX, "Custom3") \
+  X(float,  customParam4,   0.0f,              -FLT_MAX, FLT_MAX, "Custom4")
 
 // Default configuration structure
 struct DeviceConfig {
-  String deviceName;
-  String theme;
-  bool enableOTA;
-  bool enableTelnet;
-  int telnetPort;
-  int updateInterval;
-  String customParam1;
-  String customParam2;
-  int customParam3;
-  float customParam4;
+#define EASYCONNECT_CONFIG_MEMBER(type, name, def, lo, hi, label) type name;
+  EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_MEMBER)
+#undef EASYCONNECT_CONFIG_MEMBER
+};
+
+// Bytes a field adds to a JsonDocument beyond its slot (copied string)
+template <typename T> struct ConfigFieldSize {
+  static constexpr size_t extra(double maxLength) { return 0; }
+};
+template <> struct ConfigFieldSize<String> {
+  static constexpr size_t extra(double maxLength) { return JSON_STRING_SIZE((size_t)maxLength); }
+};
+
+#define EASYCONNECT_CONFIG_COUNT(type, name, def, lo, hi, label) + 1
+#define EASYCONNECT_CONFIG_EXTRA(type, name, def, lo, hi, label) + ConfigFieldSize<type>::extra(hi) + sizeof(#name)
+static const size_t CONFIG_FIELD_COUNT = 0 EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_COUNT);
+// Exact capacity for a full config object, keys and strings copied
+static const size_t CONFIG_JSON_CAPACITY =
+  JSON_OBJECT_SIZE(CONFIG_FIELD_COUNT) EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_EXTRA);
+// Parse capacity for config JSON the firmware did not write itself (POST
+// bodies, legacy and older slot files); overlong strings are clamped after
+static const size_t CONFIG_JSON_INPUT_CAPACITY = CONFIG_JSON_CAPACITY > 1024 ? CONFIG_JSON_CAPACITY : 1024;
+#undef EASYCONNECT_CONFIG_COUNT
+#undef EASYCONNECT_CONFIG_EXTRA
+
+// Schema maximum per field (longest length for strings), e.g. ConfigLimits::deviceName
+struct ConfigLimits {
+#define EASYCONNECT_CONFIG_LIMIT(type, name, def, lo, hi, label) static constexpr double name = hi;
+  EASYCONNECT_CONFIG_FIELDS(EASYCONNECT_CONFIG_LIMIT)
+#undef EASYCONNECT_CONFIG_LIMIT
+};
+
+// Non-blocking line assembler for telnet input
+struct TelnetLineBuffer {
+  enum Result { PENDING, LINE, OVERFLOW };
+  static const size_t CAPACITY = 128;   // Longest accepted line including terminator
+  
+  char data[CAPACITY];
+  size_t length;
+  bool skipLF;      // Previous terminator was CR; swallow a following LF (CRLF)
+  bool overflowed;  // Current line exceeded CAPACITY and is being discarded
+  uint8_t iacState; // Telnet IAC negotiation bytes still to skip
+  
+  void reset();
+  Result feed(uint8_t c);
+};
+
+// What to do when a telnet client's output queue is full
+enum TelnetOverflowPolicy {
+  TELNET_DROP_OLDEST,  // Discard the oldest queued bytes to make room
+  TELNET_DROP_CLIENT,  // Disconnect the client that cannot keep up
+  TELNET_COALESCE      // Drop new output and report it once as a single notice
+};
+
+// Bounded per-client output queue, flushed with non-blocking writes
+struct TelnetOutputQueue {
+  static const size_t CAPACITY = 2048;
+  
+  uint8_t data[CAPACITY];
+  size_t head;            // Index of the oldest queued byte
+  size_t count;           // Bytes currently queued
+  uint32_t droppedBytes;  // Bytes discarded since the client connected
+  uint32_t pendingNotice; // Bytes dropped since the last coalesce notice
+  
+  void reset();
+  size_t space() const { return CAPACITY - count; }
+  void push(const uint8_t* bytes, size_t len);
+  void discard(size_t len);
 };
 
 // Telnet client management
 struct TelnetClient {
   WiFiClient client;
   bool connected;
+  bool backlog;  // RX budget ran out; the rest may sit in WiFiClient, unseen by select()
   unsigned long lastActivity;
+  TelnetLineBuffer input;
+  TelnetOutputQueue output;
+};
+
+// Log severity stored with every log record
+enum LogLevel : uint8_t {
+  LOGLEVEL_DEBUG,
+  LOGLEVEL_INFO,
+  LOGLEVEL_WARN,
+  LOGLEVEL_ERROR
+};
+
+// Fixed-size log record; payloads longer than PAYLOAD_SIZE - 1 are truncated
+struct LogRecord {
+  static const size_t TAG_SIZE = 12;
+  static const size_t PAYLOAD_SIZE = 192;
+  
+  uint32_t timestamp;  // millis() when the record was produced
+  uint8_t level;       // LogLevel
+  bool newline;        // Sinks terminate the payload with CRLF
+  uint16_t length;     // Payload bytes, excluding the terminating NUL
+  char tag[TAG_SIZE];
+  char payload[PAYLOAD_SIZE];
+};
+
+// Preallocated multi-producer / single-consumer ring of log records.
+// Producers claim a slot with a compare-and-swap on the write position,
+// so logging never allocates and is safe from any task or ISR. The
+// loop() task is the only consumer.
+class LogRing {
+public:
+  static const uint32_t SLOTS = 32;  // Must be a power of two
+  
+  LogRing();
+  LogRecord* claim(uint32_t& ticket);  // nullptr when the ring is full
+  void commit(uint32_t ticket);
+  const LogRecord* peek();
+  void release();
+  uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+  
+private:
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+  };
+  Slot slots[SLOTS];
+  std::atomic<uint32_t> writePos;
+  std::atomic<uint32_t> droppedCount;
+  uint32_t readPos;
+};
+
+// Last status values sent to WebSocket clients (baseline for deltas)
+struct StatusModel {
+  uint32_t sequence;  // Incremented for every delta actually sent
+  bool wifiConnected;
+  String ssid;
+  int32_t rssi;
+  String ip;
+  uint32_t freeHeap;
+  String theme;
+  String deviceName;
+  bool telnetEnabled;
+  int telnetClients;
+};
+
+// WebSocket status stream counters
+struct StatusStreamStats {
+  uint32_t deltasSent;      // Delta frames broadcast
+  uint32_t snapshotsSent;   // Full snapshots sent
+  uint32_t ticksSuppressed; // Periodic updates skipped because nothing changed
+  uint32_t bytesSent;       // Status payload bytes, multiplied by recipients
+};
+
+// Topic subscriptions of one WebSocket client
+struct WebSocketSubscription {
+  static const size_t NAME_SIZE = 24;  // Max topic/pattern length including NUL
+  static const int MAX_PATTERNS = 4;
+  
+  bool active;         // false: client never subscribed and receives every topic
+  uint32_t topicMask;  // Bit n set: subscribed to registered topic n
+  uint8_t patternCount;
+  char patterns[MAX_PATTERNS][NAME_SIZE];  // Kept to match topics registered later
+};
+
+// WebSocket fan-out counters
+struct WebSocketStats {
+  uint32_t unicastFrames;       // Frames sent to a single client
+  uint32_t broadcastFrames;     // Frames broadcast to all clients
+  uint32_t broadcastDeliveries; // Broadcast frames multiplied by recipients
+};
+
+// One named value of a telemetry sample
+struct TelemetryField {
+  const char* name;
+  float value;
+};
+
+// Binary telemetry counters
+struct TelemetryStats {
+  uint32_t frames;         // MessagePack frames published
+  uint32_t bytes;          // MessagePack bytes encoded
+  uint32_t encodeMicros;   // Time spent encoding MessagePack
+  uint32_t jsonBytes;      // Equivalent JSON size (setTelemetryComparison)
+  uint32_t jsonMicros;     // Equivalent JSON encode time (setTelemetryComparison)
+};
+
+// Live counters behind getTelemetryStats(); publishTelemetry() runs on any task
+struct TelemetryCounters {
+  std::atomic<uint32_t> frames;
+  std::atomic<uint32_t> bytes;
+  std::atomic<uint32_t> encodeMicros;
+  std::atomic<uint32_t> jsonBytes;
+  std::atomic<uint32_t> jsonMicros;
+};
+
+// One access point from the most recent WiFi scan
+struct ScanResult {
+  char ssid[33];
+  uint8_t bssid[6];
+  int32_t rssi;
+  int32_t channel;
+  bool open;
+};
+
+// WiFi link recovery counters (see serviceWiFiLink())
+struct WiFiLinkStats {
+  uint32_t disconnects;            // Link losses after being connected
+  uint32_t reconnectAttempts;      // Reconnects, roams and portal starts issued
+  uint32_t roams;                  // Reconnects to a different BSSID after a scan
+  uint32_t portalStarts;           // Escalations to the configuration portal
+  uint8_t lastReason;              // Last disconnect reason (wifi_err_reason_t)
+  unsigned long lastOutageMillis;  // Duration of the most recent outage
+  unsigned long longestOutageMillis;
+  unsigned long totalOutageMillis; // Time spent disconnected since boot
+};
+
+// Static asset serving counters (see StaticAssetHandler)
+struct AssetStats {
+  uint32_t requests;     // Dashboard asset requests answered
+  uint32_t notModified;  // Answered with 304 from If-None-Match
+  uint32_t fromFlash;    // Served from arrays embedded in the firmware
+  uint32_t fileOpens;    // Files opened on LittleFS
+  uint32_t bytesSent;    // Body bytes sent
+};
+
+// Gzip'd asset compiled into the firmware (EasyConnect_assets.h)
+struct EmbeddedAsset {
+  const char* path;
+  const char* etag;         // Strong ETag including quotes
+  const char* contentType;
+  bool immutable;
+  const uint8_t* data;
+  size_t length;
+};
+
+// One precompressed asset, embedded or listed in /assets.manifest
+struct StaticAsset {
+  String path;          // URL path, e.g. "/index.html"; stored on LittleFS as path + ".gz"
+  String etag;          // Strong ETag including quotes
+  const char* type;     // Content-Type
+  bool immutable;       // Content-hashed name, safe to cache for a year
+  const uint8_t* data;  // Embedded bytes, nullptr when served from LittleFS
+  size_t length;
+};
+
+// Serves gzip'd dashboard assets built by scripts/build_assets.py,
+// with strong ETags and 304 Not Modified revalidation
+class StaticAssetHandler : public RequestHandler {
+public:
+  static const int MAX_ASSETS = 16;
+  
+  int begin(fs::FS& fs);
+  bool canHandle(HTTPMethod method, String uri) override;
+  bool handle(WebServer& server, HTTPMethod method, String uri) override;
+  AssetStats getStats() const { return stats; }
+  
+private:
+  fs::FS* fs = nullptr;
+  StaticAsset assets[MAX_ASSETS];
+  int assetCount = 0;
+  AssetStats stats = {};
+  
+  void loadEmbedded();
+  void loadManifest();
+  StaticAsset* find(const String& uri);
+  static const char* contentType(const String& path);
+  static bool acceptsGzip(const String& acceptEncoding);
+};
+
+// Message handed from an application task to the network task
+struct NetworkMessage {
+  enum Target : uint8_t { WEBSOCKET, WEBSOCKET_CLIENT, TELNET };
+  Target target;
+  uint8_t clientNum;  // WEBSOCKET_CLIENT only
+  bool binary;        // WebSocket binary frame
+  char topic[24];     // WEBSOCKET only
+  char* data;     // malloc'd copy, freed by the network task
+  size_t length;
+};
+
+// Framework events delivered to application callbacks
+enum FrameworkEvent : uint8_t {
+  EVENT_CONNECTED,
+  EVENT_DISCONNECTED,
+  EVENT_CONFIG_CHANGED
+};
+
+// Print adapter for serializeJson(): streams a chunked HTTP response in
+// MTU-sized pieces instead of building the whole body in a String
+class ChunkedResponse : public Print {
+public:
+  static const size_t CHUNK_SIZE = 1436;  // One TCP segment on a 1500-byte MTU
+  
+  ChunkedResponse(WebServer& server, int code, const char* contentType);
+  ~ChunkedResponse() { end(); }
+  
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  void end();
+  
+  static std::atomic<uint32_t> totalBytes;  // Body bytes streamed by all chunked responses
+  
+private:
+  WebServer& server;
+  char buffer[CHUNK_SIZE];
+  size_t used = 0;
+  bool finished = false;
+  
+  void flushChunk();
+};
+
+// Where DeviceConfig is persisted (setConfigBackend())
+enum ConfigBackend : uint8_t {
+  CONFIG_BACKEND_LITTLEFS,  // JSON in CRC-checked A/B slot files
+  CONFIG_BACKEND_NVS        // One typed NVS key per field
+};
+
+// Config persistence counters
+struct ConfigStoreStats {
+  uint32_t saveRequests;   // Changes that asked for the config to be persisted
+  uint32_t flashWrites;    // Slot files actually written
+  uint32_t writesAvoided;  // Requests folded into an already pending write
+  uint32_t corruptSlots;   // Slots rejected at load (bad header, length or CRC)
+};
+
+// Last successful association, cached for enableFastConnect()
+struct FastConnectCache {
+  uint32_t magic;      // FAST_CONNECT_MAGIC when valid
+  uint32_t ip;         // Lease to reuse when fast connect reuses the address
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  int32_t channel;
+  uint8_t bssid[6];
+  char ssid[33];
+};
+
+// Startup timing, in milliseconds since boot
+struct BootStats {
+  unsigned long wifiConnectedMillis;  // First association with an IP, 0 until then
+  unsigned long firstHttpMillis;      // First HTTP request answered, 0 until then
+  bool fastConnect;                   // Boot tried the cached BSSID/channel
+  bool fastConnectFailed;             // ... and had to fall back
+};
+
+// Where a command line came from
+enum CommandSource : uint8_t {
+  COMMAND_TELNET,
+  COMMAND_WEBSOCKET,  // "cmd:<line>" text frames
+  COMMAND_REST        // POST /api/command
+};
+
+// Command permission levels, lowest first; a caller may run commands at or below its level
+enum CommandPermission : uint8_t {
+  PERMISSION_VIEWER,    // Read-only information
+  PERMISSION_OPERATOR,  // Changes runtime state
+  PERMISSION_ADMIN      // Restart, factory reset, diagnostics
+};
+
+// One command invocation: tokenized arguments in, reply text out
+struct CommandContext {
+  static const size_t LINE_SIZE = 128;  // Longest accepted command line including NUL
+  static const int MAX_ARGS = 8;
+  
+  CommandSource source;
+  int client;                    // Telnet slot or WebSocket client number, -1 for REST
+  CommandPermission permission;  // Level of the caller
+  int argc;                      // Arguments after the command name
+  const char* argv[MAX_ARGS];
+  const char* rest;              // Everything after the command name, untokenized
+  String reply;                  // Sent to the caller when the handler returns
+  bool ok;                       // Reported to WebSocket/REST callers
+  bool delivered;                // Reply already sent (sendCommandReply())
+  
+  const char* arg(int i) const { return i < argc ? argv[i] : ""; }
+};
+
+typedef void (*CommandHandler)(CommandContext& ctx, void* userData);
+
+// Registered command; strings must outlive the registry (literals)
+struct CommandEntry {
+  const char* name;
+  const char* usage;  // Argument synopsis for help, "" when none
+  const char* help;   // nullptr hides the entry from help (aliases)
+  uint32_t hash;
+  CommandPermission permission;
+  CommandHandler handler;
+  void* userData;
+  uint32_t calls;   // Dispatch count, updated on the network task
+  uint32_t micros;  // Total handler time (wraps like a counter)
+};
+
+// Handle returned by every()/after(); 0 is never a valid timer
+typedef uint32_t TimerId;
+typedef void (*TimerCallback)(void* arg);
+
+// Hierarchical timer wheel with 1 ms ticks: four levels of 64 slots cover
+// about 4.6 hours, longer delays are re-queued. Insert, cancel and expiry
+// are O(1); per-level occupancy bitmaps give the next deadline without a scan.
+// Not thread-safe: each wheel belongs to the task that runs it.
+class TimerWheel {
+public:
+  static const int MAX_TIMERS = 32;
+  static const int LEVELS = 4;
+  static const int SLOT_BITS = 6;
+  static const int SLOTS = 1 << SLOT_BITS;
+  static const uint32_t NO_DEADLINE = 0xFFFFFFFFUL;
+  
+  TimerWheel();
+  TimerId schedule(uint32_t delayMs, uint32_t periodMs, TimerCallback callback, void* arg);
+  bool cancel(TimerId id);
+  void run(uint32_t nowMs);                       // Fire everything due up to nowMs
+  uint32_t nextDeadline(uint32_t nowMs) const;    // ms until a timer may fire, NO_DEADLINE when idle
+  int size() const { return count; }
+  
+private:
+  struct Timer {
+    uint32_t expires;     // Absolute tick, wraps with millis()
+    uint32_t period;      // 0 for one-shot timers
+    TimerCallback callback;
+    void* arg;
+    uint16_t generation;  // Bumped on release so stale ids cannot cancel a reused slot
+    int8_t next;          // Slot list links, -1 terminates
+    int8_t prev;
+    uint8_t level;
+    uint8_t slot;
+    bool used;
+  };
+  
+  Timer timers[MAX_TIMERS];
+  int8_t heads[LEVELS][SLOTS];
+  uint64_t occupied[LEVELS];  // Bit per non-empty slot
+  int8_t freeHead;
+  uint32_t currentTick = 0;
+  bool started = false;
+  int count = 0;
+  
+  void link(int index);
+  void unlink(int index);
+  void release(int index);
+  void cascade(int level);
+};
+
+// Handle returned by the event hooks (onConnected() etc.); 0 is never valid
+typedef uint32_t SubscriptionId;
+
+// Ids are shared by all lists so unsubscribe() needs only the id
+inline SubscriptionId nextSubscriptionId() {
+  static SubscriptionId next = 0;
+  if (++next == 0) next = 1;
+  return next;
+}
+
+// Subscribers of one event, stored inline: function pointers, capturing
+// lambdas and bindMember() results are copied into a fixed slot, so
+// nothing is allocated and a callable larger than STORAGE fails to
+// compile. Arguments are passed down by const reference and only copied
+// where a subscriber takes them by value, so a const String& subscriber
+// costs no allocation. Higher priority runs first, equal priorities in
+// subscription order. Callbacks may subscribe or unsubscribe; that applies
+// from the next call. Not thread-safe: subscribe from setup() or the task
+// that fires the event.
+template <typename... Args>
+class DelegateList {
+public:
+  static const int CAPACITY = 6;
+  static const size_t STORAGE = 4 * sizeof(void*);  // Captured state per subscriber
+  
+  DelegateList() {
+    for (int i = 0; i < CAPACITY; i++) {
+      slots[i].id = 0;
+      slots[i].invoke = nullptr;
+    }
+  }
+  ~DelegateList() { clear(); }
+  DelegateList(const DelegateList&) = delete;
+  DelegateList& operator=(const DelegateList&) = delete;
+  
+  // 0 when the list is full
+  template <typename Callable>
+  SubscriptionId add(Callable callable, int8_t priority = 0) {
+    static_assert(sizeof(Callable) <= STORAGE, "Callable captures more than DelegateList::STORAGE bytes");
+    static_assert(alignof(Callable) <= alignof(Storage), "Callable needs stricter alignment than DelegateList storage");
+    int index = -1;
+    for (int i = 0; i < CAPACITY && index < 0; i++) {
+      if (slots[i].invoke == nullptr) index = i;
+    }
+    if (index < 0) return 0;
+    
+    Slot& slot = slots[index];
+    new (&slot.storage) Callable(callable);
+    slot.invoke = [](void* storage, const Args&... args) { (*static_cast<Callable*>(storage))(args...); };
+    slot.destroy = [](void* storage) { static_cast<Callable*>(storage)->~Callable(); };
+    slot.priority = priority;
+    slot.id = nextSubscriptionId();
+    
+    int position = count;
+    while (position > 0 && slots[order[position - 1]].priority < priority) {
+      order[position] = order[position - 1];
+      position--;
+    }
+    order[position] = index;
+    count++;
+    return slot.id;
+  }
+  
+  SubscriptionId add(void (*function)(Args...), int8_t priority = 0) {
+    if (function == nullptr) return 0;
+    return add<void (*)(Args...)>(function, priority);
+  }
+  
+  bool remove(SubscriptionId id) {
+    if (id == 0) return false;
+    for (int i = 0; i < count; i++) {
+      if (slots[order[i]].id != id) continue;
+      slots[order[i]].id = 0;
+      if (dispatching > 0) {
+        deferred = true;  // The callable may be running; destroy it afterwards
+      } else {
+        compact();
+      }
+      return true;
+    }
+    return false;
+  }
+  
+  void clear() {
+    for (int i = 0; i < count; i++) {
+      slots[order[i]].id = 0;
+    }
+    if (dispatching > 0) {
+      deferred = true;
+    } else {
+      compact();
+    }
+  }
+  
+  void operator()(const Args&... args) {
+    // Snapshot: subscribers added by a callback wait for the next call
+    uint8_t pending[CAPACITY];
+    SubscriptionId ids[CAPACITY];
+    int n = count;
+    for (int i = 0; i < n; i++) {
+      pending[i] = order[i];
+      ids[i] = slots[order[i]].id;
+    }
+    
+    dispatching++;
+    for (int i = 0; i < n; i++) {
+      Slot& slot = slots[pending[i]];
+      if (ids[i] != 0 && slot.id == ids[i]) {
+        slot.invoke(&slot.storage, args...);
+      }
+    }
+    if (--dispatching == 0 && deferred) {
+      compact();
+    }
+  }
+  
+  bool empty() const { return size() == 0; }
+  int size() const {
+    int live = 0;
+    for (int i = 0; i < count; i++) {
+      if (slots[order[i]].id != 0) live++;
+    }
+    return live;
+  }
+  
+private:
+  typedef typename std::aligned_storage<STORAGE>::type Storage;
+  struct Slot {
+    Storage storage;
+    void (*invoke)(void* storage, const Args&... args);
+    void (*destroy)(void* storage);
+    SubscriptionId id;  // 0 once unsubscribed
+    int8_t priority;
+  };
+  
+  Slot slots[CAPACITY];  // invoke == nullptr marks a free slot
+  uint8_t order[CAPACITY];  // Slot indexes by priority
+  int count = 0;
+  int dispatching = 0;   // Nesting depth of operator()
+  bool deferred = false; // Unsubscribed slots waiting for dispatch to finish
+  
+  // Release unsubscribed slots and close the gaps in order[]
+  void compact() {
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+      Slot& slot = slots[order[i]];
+      if (slot.id != 0) {
+        order[kept++] = order[i];
+      } else {
+        slot.destroy(&slot.storage);
+        slot.invoke = nullptr;
+      }
+    }
+    count = kept;
+    deferred = false;
+  }
+};
+
+// Callable for object->method(...), so member functions can subscribe:
+// EasyConnect.onConnected(bindMember(this, &Display::showOnline));
+template <typename T, typename M>
+struct MemberDelegate {
+  T* object;
+  M method;
+  template <typename... A>
+  void operator()(A&&... args) const { (object->*method)(std::forward<A>(args)...); }
+};
+
+template <typename T, typename M>
+MemberDelegate<T, M> bindMember(T* object, M method) {
+  return MemberDelegate<T, M>{object, method};
+}
+
+// Command table with open-addressed hash lookup: one hash of the typed
+// name and usually one strcmp per dispatch, however many commands exist
+class CommandRegistry {
+public:
+  static const int MAX_COMMANDS = 128;
+  static const int TABLE_SIZE = 256;  // Power of two, kept at most half full
+  
+  CommandRegistry();
+  bool add(const char* name, const char* usage, const char* help, CommandPermission permission,
+           CommandHandler handler, void* userData);
+  CommandEntry* find(const char* name, size_t length);
+  int size() const { return count; }
+  const CommandEntry& at(int index) const { return entries[index]; }
+  static uint32_t hash(const char* name, size_t length);
+  
+private:
+  CommandEntry entries[MAX_COMMANDS];
+  int16_t table[TABLE_SIZE];  // Entry index + 1, 0 when empty; linear probing
+  int count = 0;
+};
+
+// Latency histogram with fixed buckets; recording is a bucket search
+// and two relaxed atomic adds, so it can sit on every request path
+struct LatencyHistogram {
+  static const int BUCKETS = 10;
+  static const uint32_t BOUNDS[BUCKETS - 1];  // Upper bounds in microseconds; last bucket is +Inf
+  
+  std::atomic<uint32_t> counts[BUCKETS];  // Per bucket, not cumulative
+  std::atomic<uint32_t> sumMicros;        // Wraps like a counter
+  
+  void record(uint32_t elapsedMicros);
+  void reset();
+};
+
+// Records the lifetime of a scope into a histogram
+class MetricTimer {
+public:
+  explicit MetricTimer(LatencyHistogram& target) : histogram(target), start(micros()) {}
+  ~MetricTimer() { histogram.record(micros() - start); }
+  
+private:
+  LatencyHistogram& histogram;
+  unsigned long start;
+};
+
+// REST routes with their own latency histogram
+enum HttpRoute : uint8_t {
+  HTTP_ROUTE_ROOT,
+  HTTP_ROUTE_STATUS,
+  HTTP_ROUTE_CONFIG,
+  HTTP_ROUTE_SYSTEM,
+  HTTP_ROUTE_SCAN,
+  HTTP_ROUTE_COMMAND,
+  HTTP_ROUTE_METRICS,
+  HTTP_ROUTE_PERF,
+  HTTP_ROUTE_NOT_FOUND,
+  HTTP_ROUTE_COUNT
+};
+
+// Built-in WebSocket text commands
+enum WebSocketCommandKind : uint8_t {
+  WS_COMMAND_GET_STATUS,
+  WS_COMMAND_SUBSCRIBE,
+  WS_COMMAND_UNSUBSCRIBE,
+  WS_COMMAND_TOGGLE_THEME,
+  WS_COMMAND_REGISTRY,  // "cmd:<line>"
+  WS_COMMAND_CUSTOM,    // Passed to onWebSocketCommand()
+  WS_COMMAND_COUNT
+};
+
+// Streaming transports with byte counters (HTTP is derived from ChunkedResponse and AssetStats)
+enum MetricTransport : uint8_t {
+  TRANSPORT_WEBSOCKET,
+  TRANSPORT_TELNET,
+  TRANSPORT_COUNT
+};
+
+// Hot-path counters behind /metrics
+struct Metrics {
+  LatencyHistogram httpRoutes[HTTP_ROUTE_COUNT];
+  LatencyHistogram webSocketCommands[WS_COMMAND_COUNT];
+  LatencyHistogram commands[3];  // Registry dispatch, by CommandSource
+  LatencyHistogram socketWake;   // Idle wakeup on a ready socket -> end of the pass that served it
+  std::atomic<uint32_t> bytesIn[TRANSPORT_COUNT];
+  std::atomic<uint32_t> bytesOut[TRANSPORT_COUNT];
+};
+
+#if EASYCONNECT_PROFILING
+// Stages of serviceNetwork() timed by the loop profiler
+enum PerfStage : uint8_t {
+  PERF_OUTBOUND,   // processOutbound()
+  PERF_HTTP,       // server.handleClient()
+  PERF_WEBSOCKET,  // webSocket.loop()
+  PERF_OTA,        // ElegantOTA.loop()
+  PERF_LOG,        // drainLog()
+  PERF_TELNET,     // handleTelnet()
+  PERF_WIFI,       // Boot connection / link state machine
+  PERF_SCAN,       // pollScan()
+  PERF_TIMERS,     // Framework timers: status push, config flush, WiFi retries
+  PERF_STAGE_COUNT
+};
+
+// Log2-bucketed duration histogram; written only by the network task
+struct PerfHistogram {
+  static const int BUCKETS = 20;  // Bucket i counts durations below 2^i us; the last is open-ended
+  
+  uint32_t counts[BUCKETS];
+  uint32_t samples;
+  uint32_t maxMicros;
+  uint64_t totalMicros;
+  
+  void record(uint32_t elapsedMicros);
+  uint32_t percentile(uint8_t percent) const;  // Bucket upper bound, capped at maxMicros
+};
+
+struct LoopProfile {
+  PerfHistogram stages[PERF_STAGE_COUNT];
+  PerfHistogram period;  // Time between loop starts, for jitter
+  uint32_t lastStartCycles;
+};
+#endif
+
+// Loop performance counters, sampled on every loop() iteration
+struct LoopStats {
+  unsigned long iterations;          // Total loop() calls since reset
+  unsigned long iterationsPerSecond; // Rate over the last full second
+  unsigned long lastLoopMicros;      // Duration of the previous iteration
+  unsigned long maxLoopMicros;       // Worst iteration since reset
+  uint32_t minFreeHeap;              // Lowest free heap seen between iterations
+  uint32_t heapChurn;                // Sum of free-heap deltas between iterations
+};
+
+// Tickless idle counters, kept by waitForEvents()
+struct IdleStats {
+  uint32_t waits;              // Waits that actually blocked
+  uint32_t socketWakeups;      // Ended by a ready socket
+  uint32_t signalWakeups;      // Ended by another task (log record, queued send, WiFi event)
+  uint32_t timeoutWakeups;     // Ended at the next timer deadline or the wait limit
+  uint64_t idleMicros;         // Time spent blocked since reset
+  uint32_t lastServiceMicros;  // Socket ready -> end of the pass that handled it
+  uint32_t maxServiceMicros;
+};
+
+// Library servers keep their client sockets protected; these expose the
+// descriptors the idle wait selects on and the bytes already buffered
+class EasyConnectWebServer : public WebServer {
+public:
+  using WebServer::WebServer;
+  int clientFd() { return _currentClient ? _currentClient.fd() : -1; }
+  bool clientHasData() { return _currentClient.available() > 0; }
+};
+
+class EasyConnectWebSocketsServer : public WebSocketsServer {
+public:
+  using WebSocketsServer::WebSocketsServer;
+  int clientFd(uint8_t num) {
+    WSclient_t& client = _clients[num];
+    return (client.status != WSC_NOT_CONNECTED && client.tcp != nullptr) ? client.tcp->fd() : -1;
+  }
+  bool clientHasData(uint8_t num) {
+    WSclient_t& client = _clients[num];
+    return client.tcp != nullptr && client.tcp->available() > 0;
+  }
 };
 
 class ESP32S3_EasyConnect {
 private:
   // Core components
-  WebServer server;
-  WebSocketsServer webSocket;
+  EasyConnectWebServer server;
+  EasyConnectWebSocketsServer webSocket;
   WiFiManager wifiManager;
   WiFiServer telnetServer;
   
+  // Configuration portal fields (members so an asynchronous portal can use them)
+  WiFiManagerParameter portalDeviceName;
+  WiFiManagerParameter portalTheme;
+  WiFiManagerParameter portalTelnet;
+  void applyPortalParameters();
+  
+  // Boot-time WiFi: fast connect, then full connect, then a non-blocking portal
+  enum BootWiFiState : uint8_t { BOOT_WIFI_DONE, BOOT_WIFI_FAST, BOOT_WIFI_FULL, BOOT_WIFI_PORTAL };
+  static const uint32_t FAST_CONNECT_MAGIC = 0x45434643;  // "ECFC"
+  static const unsigned long FAST_CONNECT_TIMEOUT = 3000;
+  static const unsigned long FULL_CONNECT_TIMEOUT = 15000;
+  bool fastConnectEnabled = false;
+  bool fastConnectReuseAddress = false;
+  FastConnectCache fastConnectCache;
+  const char* fastConnectNamespace = "ec_fastconn";  // Apart from the config so it never looks like a stored config
+  BootWiFiState bootWiFiState = BOOT_WIFI_DONE;
+  unsigned long bootWiFiStarted = 0;
+  BootStats bootStats;
+  bool loadFastConnectCache();
+  void saveFastConnectCache();
+  bool startFastConnect();
+  void pollBootWiFi();
+  void recordWiFiUp();
+  
+  // Event-driven WiFi link recovery: reconnect -> scan and roam -> portal,
+  // with jittered exponential backoff between attempts
+  enum WiFiLinkState : uint8_t { WIFI_LINK_UP, WIFI_LINK_BACKOFF, WIFI_LINK_RECONNECTING, WIFI_LINK_SCANNING, WIFI_LINK_PORTAL };
+  static const uint8_t WIFI_LINK_EVENT_UP = 0x01;
+  static const uint8_t WIFI_LINK_EVENT_DOWN = 0x02;
+  static const unsigned long WIFI_BACKOFF_BASE = 1000;
+  static const unsigned long WIFI_BACKOFF_MAX = 60000;
+  static const unsigned long WIFI_ATTEMPT_TIMEOUT = 15000;  // No event after an attempt: count it as failed
+  static const uint32_t WIFI_RESCAN_AFTER = 3;              // Plain reconnects before scanning
+  static const uint32_t WIFI_PORTAL_AFTER = 8;              // Attempts before opening the portal
+  static const uint32_t WIFI_AUTH_FAILURE_LIMIT = 3;        // Consecutive auth failures before the portal
+  std::atomic<uint8_t> wifiLinkEvents{0};       // Set by the WiFi event task
+  std::atomic<uint8_t> wifiDisconnectReason{0};
+  WiFiLinkState wifiLinkState = WIFI_LINK_UP;
+  uint32_t wifiAttempts = 0;
+  uint32_t wifiAuthFailures = 0;
+  TimerId wifiTimer = 0;  // Backoff delay or attempt timeout, depending on the state
+  unsigned long wifiDownSince = 0;
+  uint32_t wifiRoamScanJob = 0;
+  char wifiSSID[33] = "";
+  uint8_t wifiBSSID[6] = {0};
+  WiFiLinkStats wifiLinkStats;
+  void setupWiFiEvents();
+  void serviceWiFiLink();
+  void onWiFiLinkDown(uint8_t reason);
+  void onWiFiLinkUp();
+  void scheduleWiFiAttempt();
+  void armWiFiTimer(uint32_t delayMs);
+  void startWiFiAttempt();
+  bool roamToStrongestAP();
+  static bool isAuthFailure(uint8_t reason);
+  static String describeWiFiReason(uint8_t reason);
+  
   // Configuration
   DeviceConfig config;
-  const char* configFile = "/config.json";
+  const char* configFile = "/config.json";  // Legacy single file, migrated on first save
+  
+  // Config persistence: changes are coalesced, then written to a temp file
+  // and renamed over the older of two CRC-checked slots
+  static const unsigned long CONFIG_FLUSH_DELAY = 2000;       // Quiet time before a flush
+  static const unsigned long CONFIG_FLUSH_MAX_DELAY = 10000;  // Bound while changes keep coming
+  static const size_t CONFIG_FILE_MAX = 2048;
+  const char* configSlots[2] = {"/config.a", "/config.b"};
+  const char* configTempFile = "/config.tmp";
+  uint32_t configSequence = 0;  // Sequence number of the newest valid slot
+  int configSlot = -1;          // Slot holding it, -1 when none
+  bool configDirty = false;
+  unsigned long configDirtySince = 0;
+  TimerId configFlushTimer = 0;
+  ConfigStoreStats configStoreStats;
+  void markConfigDirty();
+  void armConfigFlush();
+  void flushConfig();
+  bool readConfigSlot(const char* path, DeviceConfig& target, uint32_t& sequence);
+  bool loadLegacyConfig();
+  bool loadSlotConfig();
+  bool saveSlotConfig();
+  
+  // NVS config backend
+  ConfigBackend configBackend = CONFIG_BACKEND_LITTLEFS;
+  const char* configNamespace = "easyconnect";
+  DeviceConfig persistedConfig;  // Last values written to NVS, to skip unchanged keys
+  bool persistedConfigValid = false;
+  bool loadNvsConfig();
+  bool saveNvsConfig();
   const char* otaUsername = "admin";
   const char* otaPassword = "admin123";
   
   // Device status
   bool isConnected = false;
-  unsigned long lastUpdate = 0;
-  unsigned long lastReconnectAttempt = 0;
+  TimerId statusTimer = 0;
+  void armStatusTimer();
   unsigned long deviceUptime = 0;
   
   // Telnet management
-  static const int MAX_TELNET_CLIENTS = 3;
-  TelnetClient telnetClients[MAX_TELNET_CLIENTS];
+  static const int DEFAULT_TELNET_CLIENTS = 3;
+  static const int TELNET_CLIENT_LIMIT = 12;  // lwIP sockets are shared with HTTP and WebSocket
+  static const int TELNET_RX_BUDGET = 256;   // Max bytes read per client per loop
+  static const unsigned long TELNET_IDLE_TIMEOUT = 600000;  // Sessions idle this long are closed
+  TelnetClient* telnetClients = nullptr;     // Slot pool, allocated by setupTelnet()
+  int telnetSlots = 0;                       // Allocated pool size
+  int telnetMaxClients = DEFAULT_TELNET_CLIENTS;
+  int telnetClientCount = 0;                 // Live sessions, kept on accept/release
   bool telnetEnabled = false;
+  TimerId telnetSweepTimer = 0;
+  void acceptTelnetClient();
+  void releaseTelnetClient(int clientIndex);
+  void readTelnetClient(int clientIndex);
+  void expireTelnetClients();
+  TelnetOverflowPolicy telnetOverflowPolicy = TELNET_DROP_OLDEST;
+  void sendToTelnetClient(int clientIndex, const String& message);
+  void sendToTelnetClient(int clientIndex, const char* data, size_t length);
+  bool flushTelnetClient(int clientIndex);
+  void closeTelnetClient(int clientIndex, const char* farewell);
+  void queueTelnet(const char* data, size_t length);
   
-  // Callback function pointers
-  void (*onConnectedCallback)() = nullptr;
-  void (*onDisconnectedCallback)() = nullptr;
-  void (*onConfigChangedCallback)() = nullptr;
-  void (*customDataCallback)(JsonDocument&) = nullptr;
-  void (*telnetCommandCallback)(String, WiFiClient&) = nullptr;
-  void (*webSocketCommandCallback)(String, uint8_t) = nullptr;
+  // Log pipeline
+  LogRing logRing;
+  static const size_t LOG_DRAIN_BUDGET = 16;  // Max records fanned out per loop
+  bool webSocketLogging = false;
+  void writeLog(LogLevel level, const char* tag, const char* message, size_t length, bool newline);
+  void drainLog(size_t maxRecords);
+  
+  // Loop statistics
+  LoopStats loopStats;
+  unsigned long loopStatsWindowStart = 0;
+  unsigned long loopStatsWindowCount = 0;
+  uint32_t lastFreeHeap = 0;
+  void updateLoopStats(unsigned long loopStart);
+  
+  // Tickless idle: block in select() instead of spinning loop()
+  static const uint32_t IDLE_POLL_INTERVAL = 10;  // Cap while WiFi connect, scan or portal are polled
+  int wakeSocket = -1;                            // Loopback UDP socket other tasks poke
+  int httpListenFd = -1;                         // Listener descriptors found once at begin()
+  int webSocketListenFd = -1;
+  int telnetListenFd = -1;
+  uint16_t wakePort = 0;
+  std::atomic<bool> idleWaiting{false};           // Network side is blocked in select()
+  bool telnetBacklog = false;                     // Read budget hit with data left in WiFiClient
+  unsigned long socketReadyAt = 0;                // micros() of an unserviced socket wakeup, 0 when none
+  IdleStats idleStats;
+  unsigned long idleStatsSince = 0;
+  void setupWakeSocket();
+  void wakeNetwork();
+  bool waitForActivity(uint32_t maxWaitMs);
+  
+#if EASYCONNECT_PROFILING
+  // Loop profiler, fed from the CPU cycle counter
+  LoopProfile loopProfile;
+  uint32_t perfCyclesPerMicro = 240;
+  uint32_t recordPerfStage(PerfStage stage, uint32_t startCycles);
+  void resetLoopProfile();
+  String describeLoopProfile();
+  void handleAPIPerf();
+#endif
+  
+  // Timer wheels: framework work runs on the network task, every()/after() on loop()'s task
+  TimerWheel timers;
+  TimerWheel appTimers;
+  
+  // Network service task (opt-in, see enableNetworkTask())
+  static const uint32_t NETWORK_TASK_STACK = 8192;
+  static const UBaseType_t NETWORK_QUEUE_LENGTH = 16;
+  bool networkTaskRequested = false;
+  BaseType_t networkTaskCore = 0;
+  TaskHandle_t networkTask = nullptr;
+  QueueHandle_t outboundQueue = nullptr;  // NetworkMessage, app -> network task
+  QueueHandle_t eventQueue = nullptr;     // FrameworkEvent, network task -> app
+  SemaphoreHandle_t configMutex = nullptr;
+  DeviceConfig pendingConfig;
+  bool pendingConfigSet = false;
+  static void networkTaskEntry(void* arg);
+  void serviceNetwork();
+  bool onNetworkTask();
+  bool handOff(NetworkMessage::Target target, const char* data, size_t length,
+               uint8_t clientNum = 0, const char* topic = "", bool binary = false);
+  void processOutbound();
+  void notifyEvent(FrameworkEvent event);
+  void dispatchEvent(FrameworkEvent event);
+  void lockConfig();
+  void unlockConfig();
+  
+  // WebSocket sends, counted for fan-out statistics
+  WebSocketStats webSocketStats;
+  void webSocketBroadcast(const char* data, size_t length, bool binary = false);
+  void webSocketSend(uint8_t clientNum, const char* data, size_t length, bool binary = false);
+  
+  // WebSocket topics: registry index n maps to bit n of each client's mask
+  static const int MAX_WS_TOPICS = 32;
+  char webSocketTopics[MAX_WS_TOPICS][WebSocketSubscription::NAME_SIZE];
+  int webSocketTopicCount = 0;
+  WebSocketSubscription webSocketSubs[WEBSOCKETS_SERVER_CLIENT_MAX];
+  int topicStatus, topicLog, topicScan, topicBroadcast;
+  int resolveTopic(const char* topic);
+  static bool topicMatches(const char* pattern, const char* topic);
+  uint32_t webSocketPublish(int topicIndex, const char* data, size_t length, bool binary = false, int skipClient = -1);
+  bool subscribeClient(uint8_t clientNum, const char* pattern);
+  bool unsubscribeClient(uint8_t clientNum, const char* pattern);
+  void sendSubscriptionAck(uint8_t clientNum, const char* type, const char* pattern, bool ok);
+  
+  // Binary telemetry
+  static const size_t MAX_TELEMETRY_FIELDS = 16;
+  static const size_t TELEMETRY_FRAME_SIZE = 256;
+  TelemetryCounters telemetryCounters;
+  std::atomic<bool> telemetryComparison{false};
+  
+  // Precompressed dashboard assets
+  StaticAssetHandler assetHandler;
+  
+  // Delta-encoded status stream
+  static const int32_t STATUS_RSSI_DEADBAND = 2;        // dBm
+  static const uint32_t STATUS_HEAP_DEADBAND = 1024;    // bytes
+  StatusModel statusModel;
+  StatusStreamStats statusStats;
+  bool statusModelValid = false;
+  void publishStatusDelta(int skipClient);
+  void sendStatusSnapshot(int clientNum);
+  
+  // Asynchronous WiFi scan with cached results
+  static const int MAX_SCAN_RESULTS = 32;
+  ScanResult scanResults[MAX_SCAN_RESULTS];
+  int scanResultCount = 0;
+  bool scanInProgress = false;
+  bool scanResultsValid = false;
+  uint32_t scanJobId = 0;
+  unsigned long scanCompletedAt = 0;
+  unsigned long scanCacheTTL = 30000;
+  void startScan();
+  void pollScan();
+  void serializeScanResults(JsonArray networks);
+  void streamScanResults(Print& out);
+  
+  // Event subscribers
+  DelegateList<> connectedHandlers;
+  DelegateList<> disconnectedHandlers;
+  DelegateList<> configChangedHandlers;
+  DelegateList<JsonDocument&> customDataHandlers;
+  DelegateList<String, WiFiClient&> telnetCommandHandlers;
+  DelegateList<String, uint8_t> webSocketCommandHandlers;
+  
+  // Command registry shared by telnet, WebSocket and REST
+  CommandRegistry commands;
+  CommandPermission sourcePermission[3] = {PERMISSION_ADMIN, PERMISSION_OPERATOR, PERMISSION_OPERATOR};
+  void registerBuiltinCommands();
+  bool dispatchCommand(CommandContext& ctx, const String& line);
+  void handleAPICommand();
+  
+  // Prometheus metrics (/metrics)
+  Metrics metrics;
+  void handleMetrics();
+  String describeStats();
 
 public:
   ESP32S3_EasyConnect();
   
   // Core initialization
+  void enableNetworkTask(BaseType_t core = 0);
+  void enableFastConnect(bool reuseAddress = false);
   bool begin(const char* deviceName = "ESP32-S3-Device");
   void loop();
   
   // Configuration management
+  void setConfigBackend(ConfigBackend backend);  // Call before begin()
   bool loadConfig();
   bool saveConfig();
+  static void resetConfig(DeviceConfig& target);
+  static void writeConfigJson(const DeviceConfig& source, JsonObject out);
+  static int readConfigJson(DeviceConfig& target, JsonObjectConst in);
+  static void clampConfig(DeviceConfig& target);  // Truncate strings and clamp numbers to the schema
+  static String describeConfig(const DeviceConfig& source);
   DeviceConfig getConfig();
   void setConfig(const DeviceConfig& newConfig);
   
@@ -90,13 +1120,23 @@ public:
   // Telnet server setup
   void setupTelnet();
   void handleTelnet();
+  void processTelnetCommand(int clientIndex, String command);
   void broadcastTelnet(String message);
   void sendToTelnet(String message);
+  void setTelnetOverflowPolicy(TelnetOverflowPolicy policy);
+  void setMaxTelnetClients(int maxClients);  // Call before begin()
   
-  // Logging system (Serial + Telnet)
-  void log(String message);
-  void logln(String message);
+  // Logging system (Serial + Telnet + optional WebSocket)
+  void log(const char* message);
+  void log(const String& message);
+  void logln(const char* message);
+  void logln(const String& message);
   void logf(const char* format, ...);
+  void logEvent(LogLevel level, const char* tag, const char* format, ...);
+  void logFromISR(LogLevel level, const char* tag, const char* message);
+  void flushLog();
+  void setWebSocketLogging(bool enabled);
+  uint32_t getDroppedLogCount();
   
   // API Endpoints
   void handleRoot();
@@ -111,29 +1151,96 @@ public:
   
   // Utility functions
   void sendDeviceStatus();
+  StatusStreamStats getStatusStreamStats();
   void restartDevice();
   void factoryReset();
   bool isWiFiConnected();
   
-  // Callback setters
-  void onConnected(void (*callback)());
-  void onDisconnected(void (*callback)());
-  void onConfigChanged(void (*callback)());
-  void setCustomDataCallback(void (*callback)(JsonDocument&));
-  void onTelnetCommand(void (*callback)(String, WiFiClient&));
-  void onWebSocketCommand(void (*callback)(String, uint8_t));
+  // Event hooks: each adds a subscriber (function, capturing lambda or
+  // bindMember()); higher priority runs first. 0 when the event is full.
+  template <typename Callable> SubscriptionId onConnected(Callable callback, int8_t priority = 0) {
+    return connectedHandlers.add(callback, priority);
+  }
+  template <typename Callable> SubscriptionId onDisconnected(Callable callback, int8_t priority = 0) {
+    return disconnectedHandlers.add(callback, priority);
+  }
+  template <typename Callable> SubscriptionId onConfigChanged(Callable callback, int8_t priority = 0) {
+    return configChangedHandlers.add(callback, priority);
+  }
+  template <typename Callable> SubscriptionId setCustomDataCallback(Callable callback, int8_t priority = 0) {
+    return customDataHandlers.add(callback, priority);
+  }
+  template <typename Callable> SubscriptionId onTelnetCommand(Callable callback, int8_t priority = 0) {
+    return telnetCommandHandlers.add(callback, priority);
+  }
+  template <typename Callable> SubscriptionId onWebSocketCommand(Callable callback, int8_t priority = 0) {
+    return webSocketCommandHandlers.add(callback, priority);
+  }
+  // nullptr removes every subscriber of the event, as it cleared the single callback before
+  SubscriptionId onConnected(std::nullptr_t) { connectedHandlers.clear(); return 0; }
+  SubscriptionId onDisconnected(std::nullptr_t) { disconnectedHandlers.clear(); return 0; }
+  SubscriptionId onConfigChanged(std::nullptr_t) { configChangedHandlers.clear(); return 0; }
+  SubscriptionId setCustomDataCallback(std::nullptr_t) { customDataHandlers.clear(); return 0; }
+  SubscriptionId onTelnetCommand(std::nullptr_t) { telnetCommandHandlers.clear(); return 0; }
+  SubscriptionId onWebSocketCommand(std::nullptr_t) { webSocketCommandHandlers.clear(); return 0; }
+  bool unsubscribe(SubscriptionId id);
+  
+  // Commands (telnet, WebSocket "cmd:<line>", POST /api/command)
+  bool registerCommand(const char* name, const char* usage, const char* help, CommandPermission permission,
+                       CommandHandler handler, void* userData = nullptr);
+  void setCommandPermission(CommandSource source, CommandPermission permission);
+  void sendCommandReply(CommandContext& ctx);
   
   // Developer utilities
   void printDebugInfo();
   String getIPAddress();
   unsigned long getUptime();
   
+  // Timers; callbacks run from loop() on the caller's task
+  TimerId every(uint32_t intervalMs, void (*callback)());
+  TimerId after(uint32_t delayMs, void (*callback)());
+  TimerId every(uint32_t intervalMs, TimerCallback callback, void* arg);
+  TimerId after(uint32_t delayMs, TimerCallback callback, void* arg);
+  bool cancelTimer(TimerId id);
+  uint32_t getNextDeadline();  // ms until the next timer, TimerWheel::NO_DEADLINE when none
+  
+  // Tickless idle
+  static const uint32_t IDLE_MAX_WAIT = 1000;  // Libraries still poll some timeouts (OTA reboot, HTTP keep-alive)
+  void waitForEvents(uint32_t maxWaitMs = IDLE_MAX_WAIT);  // Sleep until a socket, event or timer needs loop()
+  IdleStats getIdleStats();
+  
+  // Loop statistics
+  LoopStats getLoopStats();
+  void resetLoopStats();
+  
   // Telnet utilities
   int getTelnetClientCount();
   void disconnectTelnetClients();
   
-  // WebSocket broadcast
+  // WebSocket messaging
   void broadcastWebSocket(String message);
+  void sendWebSocket(uint8_t clientNum, String message);
+  void publishWebSocket(const char* topic, String message);
+  
+  // Binary telemetry (MessagePack frames: {"t":topic,"ts":millis,"v":{name:value}})
+  bool publishTelemetry(const char* topic, const TelemetryField* fields, size_t count);
+  bool publishTelemetry(const char* topic, std::initializer_list<TelemetryField> fields);
+  void setTelemetryComparison(bool enabled);
+  TelemetryStats getTelemetryStats();
+  WebSocketStats getWebSocketStats();
+  
+  // WiFi scan
+  void setScanCacheTTL(unsigned long ttlMs);
+  
+  // Static assets
+  AssetStats getAssetStats();
+  
+  // Config persistence
+  ConfigStoreStats getConfigStoreStats();
+  
+  // Boot timing
+  BootStats getBootStats();
+  WiFiLinkStats getWiFiLinkStats();
 };
 
 // Global instance for easy access
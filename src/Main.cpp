@@ -10,8 +10,6 @@ float temperature = 23.5;
 float humidity = 65.2;
 float pressure = 1013.25;
 int ledState = 0;
-unsigned long lastSensorUpdate = 0;
-unsigned long lastBroadcast = 0;
 
 void setup() {
   // Initialize framework with custom device name
@@ -22,9 +20,21 @@ void setup() {
   EasyConnect.onDisconnected(onWifiDisconnected);
   EasyConnect.onConfigChanged(onConfigChanged);
   EasyConnect.setCustomDataCallback(addCustomData);
-  EasyConnect.onTelnetCommand(handleTelnetCommand);
   EasyConnect.onWebSocketCommand(handleWebSocketCommand);
   
+  // Hooks take several subscribers, and lambdas may capture state
+  unsigned long setupStarted = millis();
+  EasyConnect.onConnected([setupStarted]() {
+    EasyConnect.logln("⏱️ Online " + String(millis() - setupStarted) + " ms after setup");
+  });
+  
+  // Custom commands, available over telnet, WebSocket ("cmd:sensors") and POST /api/command
+  EasyConnect.registerCommand("sensors", "", "Show sensor readings", PERMISSION_VIEWER, commandSensors);
+  EasyConnect.registerCommand("led", "<on|off|toggle>", "Switch the LED", PERMISSION_OPERATOR, commandLed);
+  EasyConnect.registerCommand("toggle", "", "Toggle the LED", PERMISSION_OPERATOR, commandLed);
+  EasyConnect.registerCommand("set", "<temp|hum> <value>", "Override a sensor reading", PERMISSION_OPERATOR, commandSet);
+  EasyConnect.registerCommand("reboot", "", "Reboot device", PERMISSION_ADMIN, commandReboot);
+  
   // Configure custom parameters
   DeviceConfig config = EasyConnect.getConfig();
   config.customParam1 = "Sensor Unit";
@@ -33,6 +43,11 @@ void setup() {
   config.customParam4 = 1.5;
   EasyConnect.setConfig(config);
   
+  // Periodic work
+  EasyConnect.every(2000, updateSensors);
+  EasyConnect.every(10000, logSensors);
+  EasyConnect.every(30000, broadcastUptime);
+  
   // Setup LED pin for demonstration
   pinMode(LED_BUILTIN, OUTPUT);
   digitalWrite(LED_BUILTIN, ledState);
@@ -43,23 +58,16 @@ void setup() {
 }
 
 void loop() {
-  // Required: Handle framework operations
+  // Required: Handle framework operations and run timers
   EasyConnect.loop();
   
-  // Update sensor readings every 2 seconds
-  if (millis() - lastSensorUpdate > 2000) {
-    updateSensors();
-    lastSensorUpdate = millis();
-  }
-  
-  // Broadcast status every 30 seconds
-  if (millis() - lastBroadcast > 30000) {
-    EasyConnect.broadcastTelnet("📢 System broadcast: Uptime " + String(EasyConnect.getUptime() / 1000) + "s, Temp: " + String(temperature) + "°C\r\n");
-    EasyConnect.broadcastWebSocket("Broadcast: System running for " + String(EasyConnect.getUptime() / 1000) + " seconds");
-    lastBroadcast = millis();
-  }
-  
-  delay(100);
+  // Sleep until a socket, framework event or timer needs attention
+  EasyConnect.waitForEvents();
+}
+
+void broadcastUptime() {
+  EasyConnect.broadcastTelnet("📢 System broadcast: Uptime " + String(EasyConnect.getUptime() / 1000) + "s, Temp: " + String(temperature) + "°C\r\n");
+  EasyConnect.broadcastWebSocket("Broadcast: System running for " + String(EasyConnect.getUptime() / 1000) + " seconds");
 }
 
 void onWifiConnected() {
@@ -103,58 +111,56 @@ void addCustomData(JsonDocument& doc) {
   location["room"] = EasyConnect.getConfig().customParam2;
 }
 
-void handleTelnetCommand(String command, WiFiClient& client) {
-  if (command == "sensors") {
-    client.print("📊 Current Sensor Readings:\r\n");
-    client.print("  Temperature: " + String(temperature) + " °C\r\n");
-    client.print("  Humidity: " + String(humidity) + " %\r\n");
-    client.print("  Pressure: " + String(pressure) + " hPa\r\n");
-    client.print("  LED State: " + String(ledState ? "ON" : "OFF") + "\r\n");
-    client.print("> ");
-    
-  } else if (command == "led on") {
+void commandSensors(CommandContext& ctx, void* userData) {
+  ctx.reply = "📊 Current Sensor Readings:\r\n";
+  ctx.reply += "  Temperature: " + String(temperature) + " °C\r\n";
+  ctx.reply += "  Humidity: " + String(humidity) + " %\r\n";
+  ctx.reply += "  Pressure: " + String(pressure) + " hPa\r\n";
+  ctx.reply += "  LED State: " + String(ledState ? "ON" : "OFF") + "\r\n";
+}
+
+void commandLed(CommandContext& ctx, void* userData) {
+  // "toggle" is registered to this handler without arguments
+  String mode = ctx.argc > 0 ? ctx.arg(0) : "toggle";
+  if (mode == "on") {
     ledState = 1;
-    digitalWrite(LED_BUILTIN, ledState);
-    client.print("💡 LED turned ON\r\n");
-    client.print("> ");
-    EasyConnect.broadcastTelnet("💡 LED state changed to ON\r\n");
-    
-  } else if (command == "led off") {
+  } else if (mode == "off") {
     ledState = 0;
-    digitalWrite(LED_BUILTIN, ledState);
-    client.print("💡 LED turned OFF\r\n");
-    client.print("> ");
-    EasyConnect.broadcastTelnet("💡 LED state changed to OFF\r\n");
-    
-  } else if (command == "toggle") {
+  } else if (mode == "toggle") {
     ledState = !ledState;
-    digitalWrite(LED_BUILTIN, ledState);
-    client.print("💡 LED toggled to " + String(ledState ? "ON" : "OFF") + "\r\n");
-    client.print("> ");
-    EasyConnect.broadcastTelnet("💡 LED toggled to " + String(ledState ? "ON" : "OFF") + "\r\n");
-    
-  } else if (command == "reboot") {
-    client.print("🔄 Rebooting device...\r\n");
-    delay(1000);
-    ESP.restart();
-    
-  } else if (command.startsWith("set temp ")) {
-    String value = command.substring(9);
-    temperature = value.toFloat();
-    client.print("🌡️ Temperature set to " + String(temperature) + " °C\r\n");
-    client.print("> ");
-    
-  } else if (command.startsWith("set hum ")) {
-    String value = command.substring(8);
-    humidity = value.toFloat();
-    client.print("💧 Humidity set to " + String(humidity) + " %\r\n");
-    client.print("> ");
-    
   } else {
-    client.print("❌ Unknown custom command: '" + command + "'\r\n");
-    client.print("💡 Available custom commands: sensors, led on, led off, toggle, reboot, set temp X, set hum X\r\n");
-    client.print("> ");
+    ctx.ok = false;
+    ctx.reply = "❌ Usage: led <on|off|toggle>\r\n";
+    return;
   }
+  
+  digitalWrite(LED_BUILTIN, ledState);
+  ctx.reply = "💡 LED turned " + String(ledState ? "ON" : "OFF") + "\r\n";
+  EasyConnect.broadcastTelnet("💡 LED state changed to " + String(ledState ? "ON" : "OFF") + "\r\n");
+}
+
+void commandSet(CommandContext& ctx, void* userData) {
+  String field = ctx.arg(0);
+  if (ctx.argc < 2) {
+    ctx.ok = false;
+    ctx.reply = "❌ Usage: set <temp|hum> <value>\r\n";
+  } else if (field == "temp") {
+    temperature = atof(ctx.arg(1));
+    ctx.reply = "🌡️ Temperature set to " + String(temperature) + " °C\r\n";
+  } else if (field == "hum") {
+    humidity = atof(ctx.arg(1));
+    ctx.reply = "💧 Humidity set to " + String(humidity) + " %\r\n";
+  } else {
+    ctx.ok = false;
+    ctx.reply = "❌ Unknown sensor '" + field + "' (temp, hum)\r\n";
+  }
+}
+
+void commandReboot(CommandContext& ctx, void* userData) {
+  ctx.reply = "🔄 Rebooting device...\r\n";
+  EasyConnect.sendCommandReply(ctx);
+  // Saves pending config and flushes telnet output before restarting
+  EasyConnect.restartDevice();
 }
 
 void handleWebSocketCommand(String command, uint8_t clientNum) {
@@ -162,13 +168,13 @@ void handleWebSocketCommand(String command, uint8_t clientNum) {
     String sensorData = "{\"type\":\"sensorData\",\"temperature\":" + String(temperature) + 
                        ",\"humidity\":" + String(humidity) + ",\"pressure\":" + String(pressure) + 
                        ",\"ledState\":" + String(ledState) + "}";
-    EasyConnect.broadcastWebSocket(sensorData);
+    EasyConnect.sendWebSocket(clientNum, sensorData);  // Reply to the requester only
     
   } else if (command == "toggleLED") {
     ledState = !ledState;
     digitalWrite(LED_BUILTIN, ledState);
     String response = "{\"type\":\"ledState\",\"state\":" + String(ledState) + "}";
-    EasyConnect.broadcastWebSocket(response);
+    EasyConnect.publishWebSocket("sensors/led", response);
     EasyConnect.broadcastTelnet("💡 WebSocket: LED toggled to " + String(ledState ? "ON" : "OFF") + "\r\n");
     
   } else if (command.startsWith("setTemperature:")) {
@@ -194,15 +200,14 @@ void updateSensors() {
   humidity = constrain(humidity, 30.0, 80.0);
   pressure = constrain(pressure, 980.0, 1040.0);
   
-  // Log sensor updates occasionally
-  static unsigned long lastLog = 0;
-  if (millis() - lastLog > 10000) {
-    EasyConnect.logf("📊 Sensors - Temp: %.1f°C, Hum: %.1f%%, Press: %.1fhPa\n", temperature, humidity, pressure);
-    lastLog = millis();
-  }
-  
-  // Send sensor updates via WebSocket
-  String sensorUpdate = "{\"type\":\"sensorUpdate\",\"temperature\":" + String(temperature) + 
-                       ",\"humidity\":" + String(humidity) + ",\"pressure\":" + String(pressure) + "}";
-  EasyConnect.broadcastWebSocket(sensorUpdate);
+  // Send sensor updates as a compact binary WebSocket frame
+  EasyConnect.publishTelemetry("sensors/environment", {
+    {"temperature", temperature},
+    {"humidity", humidity},
+    {"pressure", pressure}
+  });
+}
+
+void logSensors() {
+  EasyConnect.logf("📊 Sensors - Temp: %.1f°C, Hum: %.1f%%, Press: %.1fhPa\n", temperature, humidity, pressure);
 }